@@ -24,6 +24,7 @@ namespace Ising_OPV {
 		Site site;
 		sites.assign(Length*Width*Height, site);
 		gen.seed((int)time(0));
+		Modification_count++;
 	}
 
 	void Lattice::calculateDestinationCoords(const Coords& coords_initial, const int i, const int j, const int k, Coords& coords_dest) const {
@@ -213,6 +214,10 @@ namespace Ising_OPV {
 		return Length;
 	}
 
+	unsigned long Lattice::getModificationCount() const {
+		return Modification_count;
+	}
+
 	long int Lattice::getNumSites() const {
 		return (long int)sites.size();
 	}
@@ -305,14 +310,27 @@ namespace Ising_OPV {
 		Height = height_new;
 		Site site;
 		sites.assign(length_new*width_new*height_new, site);
+		Modification_count++;
 	}
 
 	void Lattice::setSiteType(const long int site_index, const char site_type) {
 		sites[site_index].type = site_type;
+		Modification_count++;
 	}
 
 	void Lattice::setSiteType(const int x, const int y, const int z, const char site_type) {
 		sites[getSiteIndex(x, y, z)].type = site_type;
+		Modification_count++;
+	}
+
+	void Lattice::setSiteTypes(const vector<char>& site_types) {
+		if (site_types.size() != sites.size()) {
+			throw invalid_argument("Unable to set the site types because the number of input site types does not match the number of sites in the lattice.");
+		}
+		for (size_t n = 0; n < sites.size(); n++) {
+			sites[n].type = site_types[n];
+		}
+		Modification_count++;
 	}
 
 }
@@ -170,6 +170,12 @@ namespace Ising_OPV {
 		//! \return The Length property of the lattice, which is the x-direction size.
 		int getLength() const;
 
+		//! \brief Gets the number of times the lattice has been modified.
+		//! \details The count is incremented whenever the lattice is initialized or resized or a site type is set,
+		//! so that data calculated from the lattice can be checked to see if it is out of date.
+		//! \return The number of modifications made to the lattice.
+		unsigned long getModificationCount() const;
+
 		//! \brief Gets the number of sites contained in the lattice.
 		//! \return The number of sites in the lattice.
 		long int getNumSites() const;
@@ -257,6 +263,10 @@ namespace Ising_OPV {
 		//! \param site_type is the char datatype designation for the site type.
 		void setSiteType(const int x, const int y, const int z, const char site_type);
 
+		//! \brief Sets the types of all sites in the lattice.
+		//! \param site_types is the vector of site types for all sites in site index order, which must have the same size as the lattice.
+		void setSiteTypes(const std::vector<char>& site_types);
+
 	protected:
 
 	private:
@@ -267,6 +277,7 @@ namespace Ising_OPV {
 		int Width = 0; // nm
 		int Height = 0; // nm
 		double Unit_size = 0.0; // nm
+		unsigned long Modification_count = 0;
 		std::vector<Site> sites;
 		std::mt19937_64 gen;
 	};
@@ -4,12 +4,22 @@
 // The Ising_OPV project can be found on Github at https://github.com/MikeHeiber/Ising_OPV
 
 #include "Morphology.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 using namespace tinyxml2;
 
 namespace Ising_OPV {
 
+	constexpr Morphology::NeighborOffset Morphology::Neighbor_stencil[26];
+	constexpr int Morphology::Infinite_distance_sq;
+	constexpr int Morphology::Correlation_batch_size;
+	constexpr int Morphology::Correlation_batches_min;
+	constexpr char Morphology::Binary_file_signature[9];
+	constexpr int Morphology::Binary_file_format_version;
+
 	Morphology::Morphology() {
 
 	}
@@ -64,6 +74,40 @@ namespace Ising_OPV {
 		//dtor
 	}
 
+	void Morphology::addReservoirSite(SiteReservoir& reservoir, const long int site_index) {
+		long int stream_index = reservoir.N_seen;
+		reservoir.N_seen++;
+		if (reservoir.N_max <= 0) {
+			return;
+		}
+		// Fill the reservoir with the first N_max candidate sites
+		if ((long int)reservoir.site_indices.size() < reservoir.N_max) {
+			reservoir.site_indices.push_back(site_index);
+			if ((long int)reservoir.site_indices.size() < reservoir.N_max) {
+				return;
+			}
+		}
+		// Skip over the candidate sites that are not selected
+		else if (stream_index != reservoir.N_next) {
+			return;
+		}
+		// Replace a randomly chosen site in the full reservoir with the selected site
+		else {
+			uniform_int_distribution<long int> dist(0, reservoir.N_max - 1);
+			reservoir.site_indices[dist(gen)] = site_index;
+		}
+		// Determine the stream position of the next selected site using a geometric skip length
+		// rand01 returns values in [0,1), so 1-rand01() is used to avoid taking the log of zero
+		reservoir.weight *= exp(log(1.0 - rand01()) / reservoir.N_max);
+		double skip = floor(log(1.0 - rand01()) / log1p(-reservoir.weight));
+		if (!(skip < (double)(numeric_limits<long int>::max() / 2))) {
+			reservoir.N_next = numeric_limits<long int>::max();
+		}
+		else {
+			reservoir.N_next = stream_index + 1 + (long int)skip;
+		}
+	}
+
 	void Morphology::addSiteType(const char site_type) {
 		// check to make sure site type has not already been added
 		for (int n = 0; n < (int)Site_types.size(); n++) {
@@ -79,10 +123,19 @@ namespace Ising_OPV {
 		Tortuosity_data.push_back(default_data);
 		vector<pair<double, int>> default_pairs(1, make_pair(0.0, 0));
 		InterfacialHistogram_data.push_back(default_pairs);
+		array<vector<pair<double, int>>, 3> default_hists = { { default_pairs, default_pairs, default_pairs } };
+		ChordLengthHistogram_data.push_back(default_hists);
+		array<double, 3> default_lengths = { { -1.0, -1.0, -1.0 } };
+		Mean_chord_lengths.push_back(default_lengths);
 		Domain_anisotropy_updated.push_back(false);
 		Domain_sizes.push_back(-1);
+		Domain_size_errors.push_back(-1);
+		Correlation_site_counts.push_back(0);
 		Domain_anisotropies.push_back(-1);
 		Island_volume.push_back(-1);
+		Domain_volumes.push_back(vector<long int>());
+		Connected_volumes.push_back(-1);
+		Percolating_volumes.push_back(-1);
 	}
 
 	double Morphology::calculateAdditionalEnergyChange(const long int site_index_main, const long int site_index_neighbor, const int growth_direction, const double additional_interaction) const {
@@ -192,6 +245,8 @@ namespace Ising_OPV {
 				getSiteSampling(correlation_sites_data[n], Site_types[n], Params.N_sampling_max);
 			}
 		}
+		// The partial correlation sums for each site type are kept between calls with increasing cutoff distance
+		vector<AnisotropyData> anisotropy_data(Site_types.size());
 		Domain_anisotropy_updated.assign(Site_types.size(), false);
 		bool success = false;
 		int cutoff_distance = 3;
@@ -204,7 +259,7 @@ namespace Ising_OPV {
 				// Only perform anisotropy calculations for site types that have not yet been updated and that have at least 100 site counts.
 				if (!Domain_anisotropy_updated[i] && Site_type_counts[i] > 100) {
 					cout << ID << ": Performing sampling anisotropy calculation with " << (int)correlation_sites_data[i].size() << " sites for site type " << (int)Site_types[i] << " with a cutoff of " << cutoff_distance << "..." << endl;
-					Domain_anisotropy_updated[i] = calculateAnisotropy(correlation_sites_data[i], Site_types[i], cutoff_distance);
+					Domain_anisotropy_updated[i] = calculateAnisotropy(correlation_sites_data[i], Site_types[i], cutoff_distance, anisotropy_data[i]);
 				}
 			}
 			// Check if the anisotropy has been successfully calculated for all sites types
@@ -226,93 +281,105 @@ namespace Ising_OPV {
 		}
 	}
 
-	bool Morphology::calculateAnisotropy(const vector<long int>& correlation_sites, const char site_type, const int cutoff_distance) {
+	bool Morphology::calculateAnisotropy(const vector<long int>& correlation_sites, const char site_type, const int cutoff_distance, AnisotropyData& anisotropy_data) {
 		int type_index = getSiteTypeIndex(site_type);
-		int N_sites = 0;
 		double correlation_length_x = 0;
 		double correlation_length_y = 0;
 		double correlation_length_z = 0;
 		double d1, y1, y2, slope, intercept;
-		Coords site_coords, coords_dest;
-		vector<double> correlation_x(cutoff_distance + 1, 0.0);
-		vector<double> correlation_y(cutoff_distance + 1, 0.0);
-		vector<double> correlation_z(cutoff_distance + 1, 0.0);
-		vector<int> site_count(cutoff_distance + 1, 0);
-		vector<int> site_total(cutoff_distance + 1, 0);
+		Coords site_coords;
 		// Check that correlation sites vector is not empty
 		if (!(correlation_sites.size() > 0)) {
 			cout << ID << ": Error! Vector of site tags to be used in the anisotropy calculation is empty." << endl;
 			throw invalid_argument("Error! Vector of site tags to be used in the anisotropy calculation is empty.");
 		}
-		for (int m = 0; m < (int)correlation_sites.size(); m++) {
-			if (lattice.getSiteType(correlation_sites[m]) != site_type) {
-				continue;
-			}
-			site_coords = lattice.getSiteCoords(correlation_sites[m]);
-			// Calculate correlation length in the x-direction
-			site_count.assign(cutoff_distance + 1, 0);
-			for (int i = -cutoff_distance; i <= cutoff_distance; i++) {
-				if (!lattice.checkMoveValidity(site_coords, i, 0, 0)) {
-					continue;
-				}
-				lattice.calculateDestinationCoords(site_coords, i, 0, 0, coords_dest);
-				if (lattice.getSiteType(site_coords) == lattice.getSiteType(coords_dest)) {
-					site_count[abs(i)]++;
-				}
-			}
-			for (int n = 1; n <= cutoff_distance; n++) {
-				correlation_x[n] += (double)site_count[n] / 2;
-			}
-			// Calculate correlation length in the y-direction
-			site_count.assign(cutoff_distance + 1, 0);
-			for (int j = -cutoff_distance; j <= cutoff_distance; j++) {
-				if (!lattice.checkMoveValidity(site_coords, 0, j, 0)) {
+		// Only the correlation data for the distances beyond the previous cutoff distance are calculated
+		int cutoff_old = anisotropy_data.correlation_x.empty() ? 0 : (int)anisotropy_data.correlation_x.size() - 1;
+		if (cutoff_distance > cutoff_old) {
+			anisotropy_data.correlation_x.resize(cutoff_distance + 1, 0.0);
+			anisotropy_data.correlation_y.resize(cutoff_distance + 1, 0.0);
+			anisotropy_data.correlation_z.resize(cutoff_distance + 1, 0.0);
+			int length = lattice.getLength();
+			int width = lattice.getWidth();
+			int height = lattice.getHeight();
+			bool count_sites = (cutoff_old == 0);
+			int site_count, site_total;
+			for (int m = 0; m < (int)correlation_sites.size(); m++) {
+				if (lattice.getSiteType(correlation_sites[m]) != site_type) {
 					continue;
 				}
-				lattice.calculateDestinationCoords(site_coords, 0, j, 0, coords_dest);
-				if (lattice.getSiteType(site_coords) == lattice.getSiteType(coords_dest)) {
-					site_count[abs(j)]++;
-				}
-			}
-			for (int n = 1; n <= cutoff_distance; n++) {
-				correlation_y[n] += (double)site_count[n] / 2;
-			}
-			// Calculate correlation length in the z-direction
-			site_total.assign(cutoff_distance + 1, 0);
-			site_count.assign(cutoff_distance + 1, 0);
-			for (int k = -cutoff_distance; k <= cutoff_distance; k++) {
-				if (!lattice.checkMoveValidity(site_coords, 0, 0, k)) {
-					continue;
-				}
-				lattice.calculateDestinationCoords(site_coords, 0, 0, k, coords_dest);
-				if (lattice.getSiteType(site_coords) == lattice.getSiteType(coords_dest)) {
-					site_count[abs(k)]++;
+				site_coords = lattice.getSiteCoords(correlation_sites[m]);
+				int x = site_coords.x;
+				int y = site_coords.y;
+				int z = site_coords.z;
+				// Scan along each of the lines through the starting site for the new distance shells
+				// Since the cutoff distance cannot exceed half of the lattice dimensions, periodic boundaries are crossed at most once
+				for (int n = cutoff_old + 1; n <= cutoff_distance; n++) {
+					// Calculate correlation in the x-direction
+					site_count = 0;
+					for (int i = -n; i <= n; i += 2 * n) {
+						int x_dest = x + i;
+						if (x_dest < 0 || x_dest >= length) {
+							if (!lattice.isXPeriodic()) {
+								continue;
+							}
+							x_dest += (x_dest < 0) ? length : -length;
+						}
+						if (lattice.getSiteType(x_dest, y, z) == site_type) {
+							site_count++;
+						}
+					}
+					anisotropy_data.correlation_x[n] += (double)site_count / 2;
+					// Calculate correlation in the y-direction
+					site_count = 0;
+					for (int j = -n; j <= n; j += 2 * n) {
+						int y_dest = y + j;
+						if (y_dest < 0 || y_dest >= width) {
+							if (!lattice.isYPeriodic()) {
+								continue;
+							}
+							y_dest += (y_dest < 0) ? width : -width;
+						}
+						if (lattice.getSiteType(x, y_dest, z) == site_type) {
+							site_count++;
+						}
+					}
+					anisotropy_data.correlation_y[n] += (double)site_count / 2;
+					// Calculate correlation in the z-direction, which is contiguous in memory
+					site_count = 0;
+					site_total = 0;
+					for (int k = -n; k <= n; k += 2 * n) {
+						int z_dest = z + k;
+						if (z_dest < 0 || z_dest >= height) {
+							if (!lattice.isZPeriodic()) {
+								continue;
+							}
+							z_dest += (z_dest < 0) ? height : -height;
+						}
+						if (lattice.getSiteType(x, y, z_dest) == site_type) {
+							site_count++;
+						}
+						site_total++;
+					}
+					if (site_total > 0) {
+						anisotropy_data.correlation_z[n] += (double)site_count / site_total;
+					}
 				}
-				site_total[abs(k)]++;
-			}
-			for (int n = 1; n <= cutoff_distance; n++) {
-				if (site_total[n] > 0) {
-					correlation_z[n] += (double)site_count[n] / site_total[n];
+				if (count_sites) {
+					anisotropy_data.N_sites++;
 				}
 			}
-			N_sites++;
 		}
 		// Average correlation data over all starting sites and normalize
-		double averaging = 1.0 / N_sites;
+		double averaging = 1.0 / anisotropy_data.N_sites;
 		double norm = 1.0 / (1.0 - Mix_fractions[type_index]);
-		correlation_x[0] = 1.0;
-		correlation_y[0] = 1.0;
-		correlation_z[0] = 1.0;
+		vector<double> correlation_x(cutoff_distance + 1, 1.0);
+		vector<double> correlation_y(cutoff_distance + 1, 1.0);
+		vector<double> correlation_z(cutoff_distance + 1, 1.0);
 		for (int n = 1; n <= cutoff_distance; n++) {
-			correlation_x[n] *= averaging;
-			correlation_x[n] -= Mix_fractions[type_index];
-			correlation_x[n] *= norm;
-			correlation_y[n] *= averaging;
-			correlation_y[n] -= Mix_fractions[type_index];
-			correlation_y[n] *= norm;
-			correlation_z[n] *= averaging;
-			correlation_z[n] -= Mix_fractions[type_index];
-			correlation_z[n] *= norm;
+			correlation_x[n] = (anisotropy_data.correlation_x[n] * averaging - Mix_fractions[type_index]) * norm;
+			correlation_y[n] = (anisotropy_data.correlation_y[n] * averaging - Mix_fractions[type_index]) * norm;
+			correlation_z[n] = (anisotropy_data.correlation_z[n] * averaging - Mix_fractions[type_index]) * norm;
 		}
 		// Find the bounds of where the pair-pair correlation functions reach 1/e
 		bool success_x = false;
@@ -372,7 +439,6 @@ namespace Ising_OPV {
 		vector<int> site_count, total_count;
 		double distance;
 		int bin;
-		double d1, y1, y2, slope, intercept;
 		Coords site_coords, coords_dest;
 		if (cutoff_distance > lattice.getLength() || cutoff_distance > lattice.getWidth()) {
 			cout << ID << ": Error, cutoff distance is greater than the lattice length and/or width." << endl;
@@ -449,6 +515,113 @@ namespace Ising_OPV {
 			correlation_data[n] -= mix_fraction;
 			correlation_data[n] *= norm;
 		}
+		return calculateDomainSize(correlation_data);
+	}
+
+	bool Morphology::calculateProgressiveCorrelationDistance(const int type_index, const int cutoff_distance) {
+		int N_sites_max = (int)min((long int)Params.N_sampling_max, (long int)Site_type_counts[type_index]);
+		// When only a small fraction of the sites of the type can be used, each batch is drawn at random when it is needed, so that the calculation can stop without sampling the whole lattice
+		// Otherwise, the whole sampling is drawn with a single pass over the lattice and split into batches
+		bool enable_lazy_sampling = (2 * (long int)N_sites_max <= (long int)Site_type_counts[type_index]);
+		vector<long int> correlation_sites;
+		unordered_set<long int> selected_sites;
+		if (!enable_lazy_sampling) {
+			getSiteSampling(correlation_sites, Site_types[type_index], N_sites_max);
+		}
+		// Any remaining sites are added to the last batch, so that no batch is smaller than the batch size
+		int N_batches_max = (N_sites_max > Correlation_batch_size) ? N_sites_max / Correlation_batch_size : 1;
+		vector<vector<long int>> batch_sites(N_batches_max);
+		vector<vector<double>> batch_data(N_batches_max);
+		int cutoff = cutoff_distance;
+		int N_sites = 0;
+		double domain_size = -1;
+		double domain_size_error = -1;
+		vector<double> correlation_data;
+		cout << ID << ": Performing progressive domain size calculation with up to " << N_sites_max << " sites for site type " << (int)Site_types[type_index] << " with a target relative error of " << Params.Correlation_tolerance << "..." << endl;
+		for (int b = 0; b < N_batches_max; b++) {
+			int N_batch = (b == N_batches_max - 1) ? N_sites_max - b * Correlation_batch_size : Correlation_batch_size;
+			if (enable_lazy_sampling) {
+				getRandomSites(batch_sites[b], Site_types[type_index], N_batch, selected_sites);
+			}
+			else {
+				batch_sites[b].assign(correlation_sites.begin() + (long int)b * Correlation_batch_size, correlation_sites.begin() + (long int)b * Correlation_batch_size + N_batch);
+			}
+			N_sites += N_batch;
+			// The cutoff distance is increased until the domain size of the new batch can be determined
+			double batch_domain_size = calculateCorrelationDistance(batch_sites[b], batch_data[b], Mix_fractions[type_index], cutoff);
+			while (!(batch_domain_size > 0)) {
+				cutoff++;
+				if (2 * cutoff > lattice.getLength() || 2 * cutoff > lattice.getWidth() || (lattice.isZPeriodic() && 2 * cutoff > lattice.getHeight())) {
+					cout << ID << ": Correlation calculation cutoff radius of " << cutoff << " is now too large to continue accurately calculating the correlation function for site type " << (int)Site_types[type_index] << "." << endl;
+					return false;
+				}
+				batch_domain_size = calculateCorrelationDistance(batch_sites[b], batch_data[b], Mix_fractions[type_index], cutoff);
+			}
+			// Previous batches are extended to the current cutoff distance so that all batches can be pooled
+			for (int m = 0; m < b; m++) {
+				if ((int)batch_data[m].size() < (int)batch_data[b].size()) {
+					calculateCorrelationDistance(batch_sites[m], batch_data[m], Mix_fractions[type_index], cutoff);
+				}
+			}
+			if (b + 1 < Correlation_batches_min && b + 1 < N_batches_max) {
+				continue;
+			}
+			// The pooled correlation data is the average of the batch correlation data weighted by the number of sites in each batch
+			vector<double> correlation_sums(batch_data[b].size(), 0.0);
+			for (int m = 0; m <= b; m++) {
+				for (int i = 0; i < (int)correlation_sums.size(); i++) {
+					correlation_sums[i] += batch_data[m][i] * (double)batch_sites[m].size();
+				}
+			}
+			correlation_data.resize(correlation_sums.size());
+			for (int i = 0; i < (int)correlation_sums.size(); i++) {
+				correlation_data[i] = correlation_sums[i] / (double)N_sites;
+			}
+			domain_size = calculateDomainSize(correlation_data);
+			// The jackknife standard error is calculated from the domain sizes of the pooled data with each batch left out
+			domain_size_error = -1;
+			if (b > 0) {
+				vector<double> jackknife_domain_sizes(b + 1);
+				vector<double> jackknife_data(correlation_sums.size());
+				bool success = true;
+				for (int m = 0; m <= b && success; m++) {
+					double N_jackknife = (double)(N_sites - (int)batch_sites[m].size());
+					for (int i = 0; i < (int)correlation_sums.size(); i++) {
+						jackknife_data[i] = (correlation_sums[i] - batch_data[m][i] * (double)batch_sites[m].size()) / N_jackknife;
+					}
+					jackknife_domain_sizes[m] = calculateDomainSize(jackknife_data);
+					success = (jackknife_domain_sizes[m] > 0);
+				}
+				if (success) {
+					double jackknife_avg = vector_avg(jackknife_domain_sizes);
+					double sum_sq = 0.0;
+					for (const auto item : jackknife_domain_sizes) {
+						sum_sq += (item - jackknife_avg)*(item - jackknife_avg);
+					}
+					domain_size_error = sqrt(sum_sq * (double)b / (double)(b + 1));
+				}
+			}
+			if (domain_size > 0 && domain_size_error >= 0 && domain_size_error < Params.Correlation_tolerance * domain_size) {
+				break;
+			}
+		}
+		if (!(domain_size > 0)) {
+			cout << ID << ": Warning! Could not determine the domain size of site type " << (int)Site_types[type_index] << " from the pooled correlation data." << endl;
+			return false;
+		}
+		if (!(domain_size_error >= 0 && domain_size_error < Params.Correlation_tolerance * domain_size)) {
+			cout << ID << ": Warning! The domain size of site type " << (int)Site_types[type_index] << " did not converge to the target relative error before all " << N_sites << " sampled sites were used." << endl;
+		}
+		cout << ID << ": Domain size of site type " << (int)Site_types[type_index] << " is " << domain_size << " +/- " << domain_size_error << " using " << N_sites << " sites." << endl;
+		Correlation_data[type_index] = correlation_data;
+		Domain_sizes[type_index] = domain_size;
+		Domain_size_errors[type_index] = domain_size_error;
+		Correlation_site_counts[type_index] = N_sites;
+		return true;
+	}
+
+	double Morphology::calculateDomainSize(const vector<double>& correlation_data) const {
+		double d1, y1, y2, slope, intercept;
 		// Find the bounds of where the pair-pair correlation function first crosses over the Mix_fraction
 		if (Params.Enable_mix_frac_method) {
 			for (int n = 2; n < (int)correlation_data.size(); n++) {
@@ -483,6 +656,355 @@ namespace Ising_OPV {
 		return -1;
 	}
 
+	void Morphology::calculateBrightnessThresholds(const vector<long int>& N_lower, MappedFile& data_file, vector<float>& brick, TomogramData& tomogram_data) const {
+		const unsigned int N_bins = 65536;
+		const int N_thresholds = (int)N_lower.size();
+		// Find the bin of the upper 16 key bits that contains each threshold
+		vector<long int> counts(N_bins, 0);
+		processTomogramBricks(tomogram_data, data_file, brick, [&](const int, const int) {
+			for (const auto item : brick) {
+				counts[getBrightnessKey(item) >> 16]++;
+			}
+		});
+		vector<unsigned int> upper_bits(N_thresholds, 0);
+		vector<long int> N_below(N_thresholds, 0);
+		for (int n = 0; n < N_thresholds; n++) {
+			while (N_below[n] + counts[upper_bits[n]] < N_lower[n]) {
+				N_below[n] += counts[upper_bits[n]];
+				upper_bits[n]++;
+			}
+		}
+		// Find each threshold key among the keys in its bin
+		vector<vector<long int>> lower_counts(N_thresholds, vector<long int>(N_bins, 0));
+		processTomogramBricks(tomogram_data, data_file, brick, [&](const int, const int) {
+			for (const auto item : brick) {
+				unsigned int key = getBrightnessKey(item);
+				for (int n = 0; n < N_thresholds; n++) {
+					if ((key >> 16) == upper_bits[n]) {
+						lower_counts[n][key & 0xFFFF]++;
+					}
+				}
+			}
+		});
+		tomogram_data.threshold_keys.assign(N_thresholds, 0);
+		tomogram_data.N_threshold_ties.assign(N_thresholds, 0);
+		for (int n = 0; n < N_thresholds; n++) {
+			unsigned int lower_bits = 0;
+			while (N_below[n] + lower_counts[n][lower_bits] < N_lower[n]) {
+				N_below[n] += lower_counts[n][lower_bits];
+				lower_bits++;
+			}
+			tomogram_data.threshold_keys[n] = (upper_bits[n] << 16) | lower_bits;
+			tomogram_data.N_threshold_ties[n] = N_lower[n] - N_below[n];
+		}
+	}
+
+	void Morphology::calculateChamferInterfacialDistances(vector<float>& path_distances) const {
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		long int N_sites = lattice.getNumSites();
+		vector<char> site_types(N_sites);
+		for (long int i = 0; i < N_sites; i++) {
+			site_types[i] = lattice.getSiteType(i);
+		}
+		// The neighbor offsets are ordered by increasing distance, and the distance of each offset is calculated in single precision, which is how the path distances are accumulated
+		vector<NeighborOffset> offsets(begin(Neighbor_stencil), end(Neighbor_stencil));
+		stable_sort(offsets.begin(), offsets.end(), [](const NeighborOffset& a, const NeighborOffset& b) { return a.distance_sq < b.distance_sq; });
+		vector<float> offset_distances(26);
+		vector<long int> index_deltas(26);
+		for (int m = 0; m < 26; m++) {
+			offset_distances[m] = sqrt((float)offsets[m].distance_sq);
+			index_deltas[m] = (long int)offsets[m].i*width*height + (long int)offsets[m].j*height + offsets[m].k;
+		}
+		// Calculates the site index of the neighbor of the site at (x,y,z) given by the m-th offset, or returns -1 if the neighbor is outside of the lattice
+		// The neighbors of sites away from the lattice boundaries are found directly from the site index offsets
+		auto get_neighbor_index = [&](const long int site_index, const int x, const int y, const int z, const int m) {
+			if (x > 0 && x < length - 1 && y > 0 && y < width - 1 && z > 0 && z < height - 1) {
+				return site_index + index_deltas[m];
+			}
+			int x_dest = x + offsets[m].i;
+			int y_dest = y + offsets[m].j;
+			int z_dest = z + offsets[m].k;
+			if (x_dest < 0 || x_dest >= length) {
+				if (!lattice.isXPeriodic()) {
+					return -1L;
+				}
+				x_dest += (x_dest < 0) ? length : -length;
+			}
+			if (y_dest < 0 || y_dest >= width) {
+				if (!lattice.isYPeriodic()) {
+					return -1L;
+				}
+				y_dest += (y_dest < 0) ? width : -width;
+			}
+			if (z_dest < 0 || z_dest >= height) {
+				if (!lattice.isZPeriodic()) {
+					return -1L;
+				}
+				z_dest += (z_dest < 0) ? height : -height;
+			}
+			return (long int)x_dest*width*height + (long int)y_dest*height + z_dest;
+		};
+		// Calculates the shortest distance from the candidate site to the interface by way of its known same type neighbors, or returns -1 if it has no known neighbors
+		auto calculate_candidate_distance = [&](const long int site_index) {
+			int x = (int)(site_index / ((long int)width*height));
+			int y = (int)((site_index / height) % width);
+			int z = (int)(site_index % height);
+			float d = -1;
+			for (int m = 0; m < 26; m++) {
+				long int neighbor_index = get_neighbor_index(site_index, x, y, z, m);
+				if (neighbor_index < 0 || site_types[neighbor_index] != site_types[site_index] || path_distances[neighbor_index] < 0.1) {
+					continue;
+				}
+				float d_temp = path_distances[neighbor_index] + offset_distances[m];
+				if (d < 0 || d_temp < d) {
+					d = d_temp;
+				}
+			}
+			return d;
+		};
+		int N_threads = 1;
+#ifdef _OPENMP
+		N_threads = omp_get_max_threads();
+#endif
+		vector<vector<long int>> thread_sites(N_threads);
+		vector<vector<pair<long int, float>>> thread_accepted(N_threads);
+		// Sites with an unknown distance have a path distance of zero
+		path_distances.assign(N_sites, 0);
+		// The first band contains the interfacial sites, which are assigned the distance to their nearest neighbor of a different type
+		long int N_interfacial = 0;
+#pragma omp parallel for schedule(static) reduction(+:N_interfacial)
+		for (int x = 0; x < length; x++) {
+			for (int y = 0; y < width; y++) {
+				for (int z = 0; z < height; z++) {
+					long int site_index = (long int)x*width*height + (long int)y*height + z;
+					for (int m = 0; m < 26; m++) {
+						long int neighbor_index = get_neighbor_index(site_index, x, y, z, m);
+						if (neighbor_index >= 0 && site_types[neighbor_index] != site_types[site_index]) {
+							path_distances[site_index] = offset_distances[m];
+							N_interfacial++;
+							break;
+						}
+					}
+				}
+			}
+		}
+		// The sites finalized in the previous band form the frontier, and the unknown same type neighbors of the frontier sites are the candidates for the next band
+		// Sites that are candidates are marked, so that each site is only added to the candidate list once
+		// When there are fewer unknown sites than interfacial sites, all unknown sites are instead used as the candidates for the second band
+		vector<long int> frontier;
+		vector<long int> candidates;
+		vector<char> candidate_marks(N_sites, 0);
+		bool use_unknown_sites = (N_sites - N_interfacial < N_interfacial);
+#pragma omp parallel
+		{
+			int thread_id = 0;
+#ifdef _OPENMP
+			thread_id = omp_get_thread_num();
+#endif
+#pragma omp for schedule(static)
+			for (long int i = 0; i < N_sites; i++) {
+				if ((path_distances[i] > 0.1) != use_unknown_sites) {
+					thread_sites[thread_id].push_back(i);
+					candidate_marks[i] = use_unknown_sites ? 1 : 0;
+				}
+			}
+		}
+		for (auto& sites : thread_sites) {
+			(use_unknown_sites ? candidates : frontier).insert((use_unknown_sites ? candidates : frontier).end(), sites.begin(), sites.end());
+			vector<long int>().swap(sites);
+		}
+		// Each subsequent band accepts the candidate sites with distances less than the band limit, which is incremented by one lattice unit for each band
+		// Because all neighbor distances are at least one lattice unit, the sites accepted in each band can not shorten the distances of other sites in the same band
+		float d_limit = (float)1.99;
+		while (true) {
+			d_limit += 1;
+			long int N_frontier = (long int)frontier.size();
+#pragma omp parallel
+			{
+				int thread_id = 0;
+#ifdef _OPENMP
+				thread_id = omp_get_thread_num();
+#endif
+#pragma omp for schedule(static)
+				for (long int n = 0; n < N_frontier; n++) {
+					long int site_index = frontier[n];
+					int x = (int)(site_index / ((long int)width*height));
+					int y = (int)((site_index / height) % width);
+					int z = (int)(site_index % height);
+					for (int m = 0; m < 26; m++) {
+						long int neighbor_index = get_neighbor_index(site_index, x, y, z, m);
+						if (neighbor_index < 0 || site_types[neighbor_index] != site_types[site_index] || path_distances[neighbor_index] > 0.1) {
+							continue;
+						}
+						char previous_mark;
+#pragma omp atomic capture
+						{
+							previous_mark = candidate_marks[neighbor_index];
+							candidate_marks[neighbor_index] = 1;
+						}
+						if (previous_mark == 0) {
+							thread_sites[thread_id].push_back(neighbor_index);
+						}
+					}
+				}
+#pragma omp single
+				{
+					for (auto& sites : thread_sites) {
+						candidates.insert(candidates.end(), sites.begin(), sites.end());
+						sites.clear();
+					}
+				}
+				// Candidates with distances below the band limit are accepted, and the others remain candidates if they have a known neighbor
+				thread_accepted[thread_id].clear();
+#pragma omp for schedule(static)
+				for (long int n = 0; n < (long int)candidates.size(); n++) {
+					float d = calculate_candidate_distance(candidates[n]);
+					if (d > 0 && d < d_limit) {
+						thread_accepted[thread_id].push_back(make_pair(candidates[n], d));
+					}
+					else if (d > 0) {
+						thread_sites[thread_id].push_back(candidates[n]);
+					}
+					else {
+						candidate_marks[candidates[n]] = 0;
+					}
+				}
+			}
+			// The accepted sites form the next band, which ends the calculation when it is empty
+			frontier.clear();
+			candidates.clear();
+			for (int t = 0; t < N_threads; t++) {
+				for (const auto& item : thread_accepted[t]) {
+					path_distances[item.first] = item.second;
+					frontier.push_back(item.first);
+				}
+				candidates.insert(candidates.end(), thread_sites[t].begin(), thread_sites[t].end());
+				thread_sites[t].clear();
+			}
+			if (frontier.empty()) {
+				break;
+			}
+		}
+	}
+
+	void Morphology::calculateChordLengthDistributions() {
+		int N_types = (int)Site_types.size();
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		array<int, 3> dims = { { length, width, height } };
+		array<bool, 3> periodic = { { lattice.isXPeriodic(), lattice.isYPeriodic(), lattice.isZPeriodic() } };
+		// Lookup table for converting a site type into its site type index
+		vector<int> type_indices(256, -1);
+		for (int n = 0; n < N_types; n++) {
+			type_indices[(unsigned char)Site_types[n]] = n;
+		}
+		// Chord counts are stored for each site type, each direction, and each chord length from 1 to the lattice size in that direction
+		vector<array<vector<long int>, 3>> chord_counts(N_types);
+		for (int n = 0; n < N_types; n++) {
+			for (int d = 0; d < 3; d++) {
+				chord_counts[n][d].assign(dims[d], 0);
+			}
+		}
+		// Scans the runs of same type sites along a line in the specified direction index and adds the chords to the input counts
+		auto scan_line = [&](const char* line, const int d, vector<array<vector<long int>, 3>>& counts) {
+			char current_type = line[0];
+			int current_length = 1;
+			// The first run is only recorded after the end of the line is reached, because it can be joined to the last run across a periodic boundary
+			char first_type = line[0];
+			int first_length = 0;
+			for (int i = 1; i < dims[d]; i++) {
+				if (line[i] == current_type) {
+					current_length++;
+					continue;
+				}
+				if (first_length == 0) {
+					first_length = current_length;
+				}
+				else {
+					counts[type_indices[(unsigned char)current_type]][d][current_length - 1]++;
+				}
+				current_type = line[i];
+				current_length = 1;
+			}
+			if (first_length == 0) {
+				counts[type_indices[(unsigned char)current_type]][d][dims[d] - 1]++;
+			}
+			else if (periodic[d] && current_type == first_type) {
+				counts[type_indices[(unsigned char)current_type]][d][first_length + current_length - 1]++;
+			}
+			else {
+				counts[type_indices[(unsigned char)first_type]][d][first_length - 1]++;
+				counts[type_indices[(unsigned char)current_type]][d][current_length - 1]++;
+			}
+		};
+#pragma omp parallel
+		{
+			vector<array<vector<long int>, 3>> counts_local(chord_counts);
+			vector<char> lines1;
+			vector<char> lines2;
+			// The lattice is copied one slab at a time into contiguous line buffers
+			// x-direction lines are scanned from each y-slab
+#pragma omp for
+			for (int y = 0; y < width; y++) {
+				lines1.resize((size_t)length*(size_t)height);
+				for (int x = 0; x < length; x++) {
+					for (int z = 0; z < height; z++) {
+						lines1[(size_t)z*length + x] = lattice.getSiteType(x, y, z);
+					}
+				}
+				for (int z = 0; z < height; z++) {
+					scan_line(&lines1[(size_t)z*length], 0, counts_local);
+				}
+			}
+			// y-direction and z-direction lines are scanned from each x-slab
+#pragma omp for
+			for (int x = 0; x < length; x++) {
+				lines1.resize((size_t)width*(size_t)height);
+				lines2.resize((size_t)width*(size_t)height);
+				for (int y = 0; y < width; y++) {
+					for (int z = 0; z < height; z++) {
+						char site_type = lattice.getSiteType(x, y, z);
+						lines1[(size_t)z*width + y] = site_type;
+						lines2[(size_t)y*height + z] = site_type;
+					}
+				}
+				for (int z = 0; z < height; z++) {
+					scan_line(&lines1[(size_t)z*width], 1, counts_local);
+				}
+				for (int y = 0; y < width; y++) {
+					scan_line(&lines2[(size_t)y*height], 2, counts_local);
+				}
+			}
+#pragma omp critical
+			{
+				for (int n = 0; n < N_types; n++) {
+					for (int d = 0; d < 3; d++) {
+						for (int i = 0; i < dims[d]; i++) {
+							chord_counts[n][d][i] += counts_local[n][d][i];
+						}
+					}
+				}
+			}
+		}
+		// Construct the histograms and calculate the mean chord lengths
+		for (int n = 0; n < N_types; n++) {
+			for (int d = 0; d < 3; d++) {
+				ChordLengthHistogram_data[n][d].assign(dims[d], make_pair(0.0, 0));
+				long int chord_total = 0;
+				long int length_total = 0;
+				for (int i = 0; i < dims[d]; i++) {
+					ChordLengthHistogram_data[n][d][i] = make_pair((double)(i + 1), (int)chord_counts[n][d][i]);
+					chord_total += chord_counts[n][d][i];
+					length_total += (i + 1)*chord_counts[n][d][i];
+				}
+				Mean_chord_lengths[n][d] = (chord_total > 0) ? (double)length_total / (double)chord_total : -1.0;
+			}
+		}
+	}
+
 	void Morphology::calculateCorrelationDistances() {
 		if (Params.Enable_extended_correlation_calc) {
 			cout << ID << ": Calculating the domain size using the extended pair-pair correlation function using a cutoff radius of " << Params.Extended_correlation_cutoff_distance << "..." << endl;
@@ -497,11 +1019,14 @@ namespace Ising_OPV {
 		for (int n = 0; n < (int)Site_types.size(); n++) {
 			// Select sites for correlation function calculation.
 			// Site indices for each selected site are stored in the Correlation_sites vector.
-			if ((int)correlation_sites_data[n].size() == 0) {
+			// The progressive calculation draws its own sites in batches.
+			if ((int)correlation_sites_data[n].size() == 0 && !Params.Enable_progressive_correlation_calc) {
 				getSiteSampling(correlation_sites_data[n], Site_types[n], Params.N_sampling_max);
 			}
 			// Clear the current Correlation_data
 			Correlation_data[n].clear();
+			Domain_size_errors[n] = -1;
+			Correlation_site_counts[n] = (int)correlation_sites_data[n].size();
 		}
 		vector<bool> domain_size_updated(Site_types.size(), false);
 		int cutoff_distance;
@@ -514,6 +1039,12 @@ namespace Ising_OPV {
 				cutoff_distance = 3;
 			}
 			domain_size = -1;
+			if (Params.Enable_progressive_correlation_calc) {
+				if (Site_type_counts[n] > 100) {
+					calculateProgressiveCorrelationDistance(n, cutoff_distance);
+				}
+				continue;
+			}
 			// The correlation function calculation is called with an increasing cutoff distance until successful.
 			while (!domain_size_updated[n]) {
 				if (2 * cutoff_distance > lattice.getLength() || 2 * cutoff_distance > lattice.getWidth() || (lattice.isZPeriodic() && 2 * cutoff_distance > lattice.getHeight())) {
@@ -547,134 +1078,294 @@ namespace Ising_OPV {
 		else if (Params.Enable_e_method) {
 			cout << ID << ": Calculating the depth dependent domain size from the pair-pair correlation function using the 1/e method..." << endl;
 		}
-		vector<vector<long int>> correlation_sites_data(Site_types.size());
-		vector<double> correlation_data;
-		vector<bool> domain_size_updated(Site_types.size(), false);
-		Depth_composition_data.assign(Site_types.size(), vector<double>(lattice.getHeight(), 0.0));
-		Depth_domain_size_data.assign(Site_types.size(), vector<double>(lattice.getHeight(), 0.0));
-		Depth_iv_data.assign(lattice.getHeight(), 0.0);
-		vector<int> counts(Site_types.size(), 0);
-		int site_count;
-		double mix_fraction_local;
-		Coords coords, coords_dest;
-		int counts_total = 0;
-		int cutoff_distance;
-		double domain_size;
-		for (int z = 0; z < lattice.getHeight(); z++) {
-			//cout << ID << ": Calculating depth dependent data for z = " << z << endl;
-			// Calculate depth dependent composition
-			counts.assign(Site_types.size(), 0);
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					counts[getSiteTypeIndex(lattice.getSiteType(x, y, z))]++;
+		int N_types = (int)Site_types.size();
+		int height = lattice.getHeight();
+		long int area = (long int)lattice.getLength()*(long int)lattice.getWidth();
+		Depth_composition_data.assign(N_types, vector<double>(height, 0.0));
+		Depth_domain_size_data.assign(N_types, vector<double>(height, 0.0));
+		Depth_iv_data.assign(height, 0.0);
+		// Count the number of sites of each type in each z-plane with a single pass over the lattice
+		vector<vector<long int>> z_counts(N_types, vector<long int>(height, 0));
+		for (int x = 0; x < lattice.getLength(); x++) {
+			for (int y = 0; y < lattice.getWidth(); y++) {
+				for (int z = 0; z < height; z++) {
+					z_counts[getSiteTypeIndex(lattice.getSiteType(x, y, z))][z]++;
 				}
 			}
-			for (int n = 0; n < (int)Site_types.size(); n++) {
-				Depth_composition_data[n][z] = (double)counts[n] / (double)(lattice.getLength()*lattice.getWidth());
+		}
+		// Calculate depth dependent composition
+		for (int n = 0; n < N_types; n++) {
+			for (int z = 0; z < height; z++) {
+				Depth_composition_data[n][z] = (double)z_counts[n][z] / (double)area;
 			}
-			// Calculate depth dependent interfacial volume fraction
-			site_count = 0;
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					coords.setXYZ(x, y, z);
-					if (isNearInterface(coords, 1.0)) {
-						site_count++;
-					}
-				}
+		}
+		// Calculate depth dependent interfacial volume fraction from the sites within one lattice unit of the interface in the interfacial distance field
+		const vector<int>& distances_sq = getInterfacialDistanceField();
+		vector<long int> iv_counts(height, 0);
+		for (long int m = 0; m < (long int)distances_sq.size(); m++) {
+			if (distances_sq[m] <= 1) {
+				iv_counts[m % height]++;
 			}
-			Depth_iv_data[z] = (double)site_count / (double)(lattice.getLength()*lattice.getWidth());
-			// Select sites for correlation function calculation.
-			correlation_sites_data.assign(Site_types.size(), vector<long int>(0));
-			for (int n = 0; n < (int)Site_types.size(); n++) {
-				if ((int)correlation_sites_data[n].size() == 0) {
-					getSiteSamplingZ(correlation_sites_data[n], Site_types[n], Params.N_sampling_max, z);
+		}
+		for (int z = 0; z < height; z++) {
+			Depth_iv_data[z] = (double)iv_counts[z] / (double)area;
+		}
+		// Select sites for the correlation function calculations using a single pass over the lattice that streams the sites of each type into a bucket for each z-plane
+		vector<vector<SiteReservoir>> reservoirs(N_types, vector<SiteReservoir>(height));
+		for (int n = 0; n < N_types; n++) {
+			for (int z = 0; z < height; z++) {
+				initializeReservoir(reservoirs[n][z], min((long int)Params.N_sampling_max, z_counts[n][z]));
+			}
+		}
+		long int site_index = 0;
+		for (int x = 0; x < lattice.getLength(); x++) {
+			for (int y = 0; y < lattice.getWidth(); y++) {
+				for (int z = 0; z < height; z++) {
+					addReservoirSite(reservoirs[getSiteTypeIndex(lattice.getSiteType(x, y, z))][z], site_index);
+					site_index++;
 				}
 			}
-			// Calculate depth dependent domain size
-			domain_size_updated.assign(Site_types.size(), false);
-			for (int n = 0; n < (int)Site_types.size(); n++) {
-				cutoff_distance = 5;
+		}
+		for (int n = 0; n < N_types; n++) {
+			for (int z = 0; z < height; z++) {
+				shuffle(reservoirs[n][z].site_indices.begin(), reservoirs[n][z].site_indices.end(), gen);
+			}
+		}
+		// Construct prefix sums of the z-plane site counts, which are used to calculate the local mix fraction in a z-window around each z-plane
+		vector<vector<long int>> z_count_sums(N_types, vector<long int>(height + 1, 0));
+		for (int n = 0; n < N_types; n++) {
+			for (int z = 0; z < height; z++) {
+				z_count_sums[n][z + 1] = z_count_sums[n][z] + z_counts[n][z];
+			}
+		}
+		// Calculate depth dependent domain size
+		// The z-planes are independent of each other, so they are distributed over the available threads
+#pragma omp parallel for schedule(dynamic)
+		for (int z = 0; z < height; z++) {
+			vector<double> correlation_data;
+			for (int n = 0; n < N_types; n++) {
+				int cutoff_distance = 5;
 				correlation_data.clear();
-				domain_size = -1;
+				double domain_size = -1;
 				// The correlation function calculation is called with an increasing cutoff distance until successful.
-				while (!domain_size_updated[n]) {
-					if (2 * cutoff_distance > lattice.getLength() || 2 * cutoff_distance > lattice.getWidth() || 2 * cutoff_distance > lattice.getHeight()) {
-						//cout << ID << ": Correlation calculation cutoff radius is now too large to continue accurately calculating the correlation function for site type " << (int)Site_types[n] << "." << endl;
+				while (domain_size < 0) {
+					if (2 * cutoff_distance > lattice.getLength() || 2 * cutoff_distance > lattice.getWidth() || 2 * cutoff_distance > height) {
 						break;
 					}
-					// Calculate local mix fraction
-					site_count = 0;
-					counts_total = 0;
-					for (int x = 0; x < lattice.getLength(); x++) {
-						for (int y = 0; y < lattice.getWidth(); y++) {
-							for (int k = -cutoff_distance; k <= cutoff_distance; k++) {
-								coords.setXYZ(x, y, z);
-								if (!lattice.checkMoveValidity(coords, 0, 0, k)) {
-									continue;
-								}
-								lattice.calculateDestinationCoords(coords, 0, 0, k, coords_dest);
-								if (lattice.getSiteType(coords_dest) == Site_types[n]) {
-									site_count++;
-								}
-								counts_total++;
-							}
-						}
+					// Calculate local mix fraction from the z-planes within the cutoff distance, excluding the current z-plane
+					long int site_count = 0;
+					long int counts_total = 0;
+					if (lattice.isZPeriodic()) {
+						// Sum over the periodic images of the z-window from z-cutoff_distance to z+cutoff_distance
+						auto periodic_sum = [&](const long int z_end) {
+							long int n_cycles = (z_end >= 0) ? z_end / height : -((-z_end + height - 1) / height);
+							return n_cycles * z_count_sums[n][height] + z_count_sums[n][z_end - n_cycles * height];
+						};
+						site_count = periodic_sum(z + cutoff_distance + 1) - periodic_sum(z - cutoff_distance) - z_counts[n][z];
+						counts_total = area * 2 * cutoff_distance;
+					}
+					else {
+						int z_min = max(z - cutoff_distance, 0);
+						int z_max = min(z + cutoff_distance, height - 1);
+						site_count = z_count_sums[n][z_max + 1] - z_count_sums[n][z_min] - z_counts[n][z];
+						counts_total = area * (z_max - z_min);
 					}
-					mix_fraction_local = (double)site_count / (double)counts_total;
+					double mix_fraction_local = (double)site_count / (double)counts_total;
 					if (Site_type_counts[n] > 10) {
-						//cout << ID << ": Performing sampling domain size calculation with " << (int)correlation_sites_data[n].size() << " sites for site type " << (int)Site_types[n] << " with a cutoff radius of " << cutoff_distance << "..." << endl;
-						domain_size = calculateCorrelationDistance(correlation_sites_data[n], correlation_data, mix_fraction_local, cutoff_distance);
+						domain_size = calculateCorrelationDistance(reservoirs[n][z].site_indices, correlation_data, mix_fraction_local, cutoff_distance);
 					}
 					if (domain_size > 0) {
 						Depth_domain_size_data[n][z] = domain_size;
-						domain_size_updated[n] = true;
 					}
 					else {
+						domain_size = -1;
 						cutoff_distance++;
 					}
 				}
 			}
-			// Calculate depth dependent anisotropy
 		}
 		// Reset extended correlation calculation option to original value
 		Params.Enable_extended_correlation_calc = Enable_extended_correlation_calc_old;
 	}
 
-	double Morphology::calculateDissimilarFraction(const Coords& coords, const int rescale_factor) const {
-		int site_count = 0;
-		int count_dissimilar = 0;
-		Coords coords_dest;
-		// When the rescale factor is 1, the radius is 1, and the radius increases for larger rescale factors.
-		int radius = (rescale_factor <= 2) ? 1 : (int)ceil((double)(rescale_factor + 1) / 2);
-		int cutoff_squared = (rescale_factor <= 2) ? 2 : (int)floor(intpow((rescale_factor + 1.0) / 2.0, 2));
-		for (int i = -radius; i <= radius; i++) {
-			for (int j = -radius; j <= radius; j++) {
-				for (int k = -radius; k <= radius; k++) {
-					if ((i*i + j * j + k * k) > cutoff_squared) {
-						continue;
-					}
-					if (!lattice.checkMoveValidity(coords, i, j, k)) {
-						continue;
-					}
-					lattice.calculateDestinationCoords(coords, i, j, k, coords_dest);
-					if (lattice.getSiteType(coords) != lattice.getSiteType(coords_dest)) {
-						count_dissimilar++;
+	void Morphology::calculateDistanceTransform1D(vector<int>& line, const vector<char>& line_types, const bool is_periodic, DistanceTransformData& data) const {
+		int N_values = (int)line.size();
+		// Calculates the lower envelope of the parabolas rooted at the known values in data.values and evaluates it at N_out positions starting at position start
+		// The vertices vector stores the positions of the parabolas in the envelope and the boundaries vector stores the position where each parabola starts to be the lowest
+		// The results are written to the line starting at the specified line index, wrapping around the end of the line
+		auto transform_values = [&](const int N_total, const int start, const int N_out, const int line_index) {
+			data.vertices.resize(N_total);
+			data.boundaries.resize(N_total + 1);
+			int k = -1;
+			for (int q = 0; q < N_total; q++) {
+				if (data.values[q] == Infinite_distance_sq) {
+					continue;
+				}
+				double s = -numeric_limits<double>::infinity();
+				while (k >= 0) {
+					int v = data.vertices[k];
+					s = ((double)data.values[q] - (double)data.values[v] + (double)q * q - (double)v * v) / (2.0 * (q - v));
+					if (s > data.boundaries[k]) {
+						break;
 					}
-					site_count++;
+					k--;
+				}
+				if (k < 0) {
+					s = -numeric_limits<double>::infinity();
+				}
+				k++;
+				data.vertices[k] = q;
+				data.boundaries[k] = s;
+			}
+			// The distances remain unknown if there are no known values
+			if (k < 0) {
+				return;
+			}
+			data.boundaries[k + 1] = numeric_limits<double>::infinity();
+			k = 0;
+			int index = line_index;
+			for (int q = start; q < start + N_out; q++) {
+				while (data.boundaries[k + 1] < q) {
+					k++;
+				}
+				int v = data.vertices[k];
+				line[index] = (q - v) * (q - v) + data.values[v];
+				index = (index + 1 < N_values) ? index + 1 : 0;
+			}
+		};
+		// Find a position where the site type changes, which is the start of a run of same type sites
+		int run_start = -1;
+		for (int i = (is_periodic ? 0 : 1); i < N_values; i++) {
+			if (line_types[i] != line_types[(i > 0) ? i - 1 : N_values - 1]) {
+				run_start = i;
+				break;
+			}
+		}
+		// When all sites on the line have the same type, the whole line is transformed
+		if (run_start < 0) {
+			// Periodic lines are extended on each side by up to half of the line length, which includes the nearest periodic image of every position
+			// When all values are known, the distance to the nearest feature is at most the square root of the largest value, which limits the extension needed
+			int extension = 0;
+			if (is_periodic) {
+				int max_value = 0;
+				for (const auto item : line) {
+					max_value = max(max_value, item);
 				}
+				extension = (N_values + 1) / 2;
+				if (max_value < Infinite_distance_sq) {
+					extension = min(extension, (int)sqrt((double)max_value) + 1);
+				}
+			}
+			data.values.resize(N_values + 2 * extension);
+			for (int q = 0; q < N_values + 2 * extension; q++) {
+				data.values[q] = line[(q - extension + N_values) % N_values];
+			}
+			transform_values(N_values + 2 * extension, extension, N_values, 0);
+			return;
+		}
+		// Otherwise, each run of same type sites is transformed separately, because the neighboring sites of a different type at the ends of the run are closer than any site outside of the run
+		// The sites at the ends of the run are added as features with zero distance
+		if (!is_periodic) {
+			run_start = 0;
+		}
+		data.values.resize(N_values + 2);
+		int N_processed = 0;
+		while (N_processed < N_values) {
+			bool has_lower_end = is_periodic || run_start > 0;
+			int N_total = 0;
+			if (has_lower_end) {
+				data.values[N_total++] = 0;
+			}
+			int run_length = 0;
+			int index = run_start;
+			do {
+				data.values[N_total++] = line[index];
+				run_length++;
+				index = (index + 1 < N_values) ? index + 1 : 0;
+			} while (N_processed + run_length < N_values && line_types[index] == line_types[run_start]);
+			bool has_upper_end = is_periodic || run_start + run_length < N_values;
+			if (has_upper_end) {
+				data.values[N_total++] = 0;
 			}
+			transform_values(N_total, (has_lower_end ? 1 : 0), run_length, run_start);
+			run_start = index;
+			N_processed += run_length;
 		}
-		return (double)count_dissimilar / (double)site_count;
 	}
 
-	double Morphology::calculateEnergyChangeSimple(const long int site_index1, const long int site_index2, const double interaction_energy1, const double interaction_energy2) {
-		// Used with bond formation algorithm
-		static const double one_over_sqrt2 = 1 / sqrt(2);
-		//static const double one_over_sqrt3 = 1 / sqrt(3);
-		char sum1_1_delta;
-		char sum2_1_delta;
-		//char sum3_1_delta;
-		char sum1_2_delta;
+	bool Morphology::calculateDomainConnectivity(const int N_neighbors) {
+		int max_distance_sq;
+		switch (N_neighbors) {
+		case 6:
+			max_distance_sq = 1;
+			break;
+		case 18:
+			max_distance_sq = 2;
+			break;
+		case 26:
+			max_distance_sq = 3;
+			break;
+		default:
+			cout << ID << ": Error! The number of connected neighbors must be 6, 18, or 26, but " << N_neighbors << " was entered." << endl;
+			return false;
+		}
+		auto domains = calculateDomainData(max_distance_sq);
+		int N_types = (int)Site_types.size();
+		for (int n = 0; n < N_types; n++) {
+			Domain_volumes[n].clear();
+			// Only the first two site types have an electrode.
+			Connected_volumes[n] = (n < 2) ? 0 : -1;
+			Percolating_volumes[n] = 0;
+		}
+		for (const auto& domain : domains) {
+			int n = getSiteTypeIndex(domain.site_type);
+			Domain_volumes[n].push_back(domain.volume);
+			if ((n == 0 && domain.is_bottom_connected) || (n == 1 && domain.is_top_connected)) {
+				Connected_volumes[n] += domain.volume;
+			}
+			if (domain.is_bottom_connected && domain.is_top_connected) {
+				Percolating_volumes[n] += domain.volume;
+			}
+		}
+		for (int n = 0; n < N_types; n++) {
+			sort(Domain_volumes[n].begin(), Domain_volumes[n].end(), greater<long int>());
+		}
+		return true;
+	}
+
+	vector<Morphology::DomainData> Morphology::calculateDomainData(const int max_distance_sq) const {
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		vector<long int> labels;
+		long int N_domains = labelDomains(labels, max_distance_sq);
+		vector<DomainData> domains(N_domains);
+		for (int x = 0; x < lattice.getLength(); x++) {
+			for (int y = 0; y < width; y++) {
+				long int index = lattice.getSiteIndex(x, y, 0);
+				for (int z = 0; z < height; z++) {
+					DomainData& domain = domains[labels[index + z]];
+					domain.volume++;
+					domain.site_type = lattice.getSiteType(x, y, z);
+					if (z == 0) {
+						domain.is_bottom_connected = true;
+					}
+					if (z == height - 1) {
+						domain.is_top_connected = true;
+					}
+				}
+			}
+		}
+		return domains;
+	}
+
+	double Morphology::calculateEnergyChangeSimple(const long int site_index1, const long int site_index2, const double interaction_energy1, const double interaction_energy2) {
+		// Used with bond formation algorithm
+		static const double one_over_sqrt2 = 1 / sqrt(2);
+		//static const double one_over_sqrt3 = 1 / sqrt(3);
+		char sum1_1_delta;
+		char sum2_1_delta;
+		//char sum3_1_delta;
+		char sum1_2_delta;
 		char sum2_2_delta;
 		//char sum3_2_delta;
 		double sum_1_delta, sum_2_delta;
@@ -895,101 +1586,132 @@ namespace Ising_OPV {
 		return (double)site_face_count / (double)lattice.getNumSites();
 	}
 
-	void Morphology::calculateInterfacialDistanceHistogram() {
-		Coords coords, coords_dest;
-		float d;
-		float d_temp;
-		// The shortest distance from each site to the interface is stored in the path_distances vector
-		vector<float> path_distances;
-		path_distances.assign(lattice.getNumSites(), 0);
-		// Calculate distances to the interface by expanding outward from the interface
-		// A first scan over the lattice is done to identify the sites at the interface, at a distance of less than 2 lattice units from the interface
-		// Subsequent scans expand outward 1 lattice unit at a time from these interfacial sites until no sites are left.
-		int calc_count = 1;
-		float d_current = (float)1.99;
-		while (calc_count > 0) {
-			calc_count = 0;
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					for (int z = 0; z < lattice.getHeight(); z++) {
-						coords.setXYZ(x, y, z);
-						// Only perform the calculation on sites with a yet unknown interfacial distance
-						if (path_distances[lattice.getSiteIndex(x, y, z)] < 0.1) {
-							d = -1;
-							// Look around at neighboring sites
-							for (int i = -1; i <= 1; i++) {
-								for (int j = -1; j <= 1; j++) {
-									for (int k = -1; k <= 1; k++) {
-										if (!lattice.checkMoveValidity(coords, i, j, k)) {
-											continue;
-										}
-										lattice.calculateDestinationCoords(coords, i, j, k, coords_dest);
-										// Initial scan identifies interfacial sites
-										if (d_current < 2) {
-											if (lattice.getSiteType(coords_dest) != lattice.getSiteType(x, y, z)) {
-												d_temp = sqrt((float)(i*i + j * j + k * k));
-												if (d < 0 || d_temp < d) {
-													d = d_temp;
-												}
-											}
-										}
-										// Subsequent scans identify sites of the same type
-										// A temporary distance to the interface from the target site by way of the identified neighbor site is calculated
-										// The temporary distance is only stored if it is shorter than the previous temporary distance, ensuring that the shortest interfacial distance is calculated
-										else if (lattice.getSiteType(coords_dest) == lattice.getSiteType(x, y, z) && path_distances[lattice.getSiteIndex(coords_dest)] > 0.1) {
-											d_temp = path_distances[lattice.getSiteIndex(coords_dest)] + sqrt((float)(i*i + j * j + k * k));
-											if (d < 0 || d_temp < d) {
-												d = d_temp;
-											}
-										}
-									}
-								}
-							}
-							// The temporary distance is only accepted if it less than the expansion limit (d_current).
-							if (d > 0 && d < d_current) {
-								path_distances[lattice.getSiteIndex(x, y, z)] = d;
-								calc_count++;
-							}
-						}
+	void Morphology::calculateInterfacialDistanceField(vector<int>& distances_sq) const {
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		long int N_sites = lattice.getNumSites();
+		long int plane_size = (long int)width*height;
+		vector<char> site_types(N_sites);
+		for (long int i = 0; i < N_sites; i++) {
+			site_types[i] = lattice.getSiteType(i);
+		}
+		// All distances are initially unknown, and the sites of a different type at the end of each run of same type sites are added as features by the line transform
+		distances_sq.assign(N_sites, Infinite_distance_sq);
+		// Transform the lines along the z-direction, which are contiguous in the lattice
+#pragma omp parallel
+		{
+			DistanceTransformData data;
+			vector<int> line(height);
+			vector<char> line_types(height);
+#pragma omp for
+			for (long int xy = 0; xy < (long int)length*width; xy++) {
+				long int offset = xy * height;
+				copy(site_types.begin() + offset, site_types.begin() + offset + height, line_types.begin());
+				copy(distances_sq.begin() + offset, distances_sq.begin() + offset + height, line.begin());
+				calculateDistanceTransform1D(line, line_types, lattice.isZPeriodic(), data);
+				copy(line.begin(), line.end(), distances_sq.begin() + offset);
+			}
+		}
+		// Transform the lines along the y-direction, with each thread working on separate yz-planes
+		// Each yz-plane is transposed into a buffer, so that each line is contiguous
+#pragma omp parallel
+		{
+			DistanceTransformData data;
+			vector<int> line(width);
+			vector<char> line_types(width);
+			vector<int> buffer(plane_size);
+			vector<char> type_buffer(plane_size);
+#pragma omp for
+			for (int x = 0; x < length; x++) {
+				long int offset = x * plane_size;
+				for (int y = 0; y < width; y++) {
+					for (int z = 0; z < height; z++) {
+						buffer[(long int)z*width + y] = distances_sq[offset + (long int)y*height + z];
+						type_buffer[(long int)z*width + y] = site_types[offset + (long int)y*height + z];
+					}
+				}
+				for (int z = 0; z < height; z++) {
+					copy(buffer.begin() + (long int)z*width, buffer.begin() + (long int)(z + 1)*width, line.begin());
+					copy(type_buffer.begin() + (long int)z*width, type_buffer.begin() + (long int)(z + 1)*width, line_types.begin());
+					calculateDistanceTransform1D(line, line_types, lattice.isYPeriodic(), data);
+					copy(line.begin(), line.end(), buffer.begin() + (long int)z*width);
+				}
+				for (int y = 0; y < width; y++) {
+					for (int z = 0; z < height; z++) {
+						distances_sq[offset + (long int)y*height + z] = buffer[(long int)z*width + y];
+					}
+				}
+			}
+		}
+		// Transform the lines along the x-direction, with each thread working on separate xz-planes that are transposed in the same way
+#pragma omp parallel
+		{
+			DistanceTransformData data;
+			vector<int> line(length);
+			vector<char> line_types(length);
+			vector<int> buffer((long int)length*height);
+			vector<char> type_buffer((long int)length*height);
+#pragma omp for
+			for (int y = 0; y < width; y++) {
+				long int offset = (long int)y*height;
+				for (int x = 0; x < length; x++) {
+					for (int z = 0; z < height; z++) {
+						buffer[(long int)z*length + x] = distances_sq[x * plane_size + offset + z];
+						type_buffer[(long int)z*length + x] = site_types[x * plane_size + offset + z];
+					}
+				}
+				for (int z = 0; z < height; z++) {
+					copy(buffer.begin() + (long int)z*length, buffer.begin() + (long int)(z + 1)*length, line.begin());
+					copy(type_buffer.begin() + (long int)z*length, type_buffer.begin() + (long int)(z + 1)*length, line_types.begin());
+					calculateDistanceTransform1D(line, line_types, lattice.isXPeriodic(), data);
+					copy(line.begin(), line.end(), buffer.begin() + (long int)z*length);
+				}
+				for (int x = 0; x < length; x++) {
+					for (int z = 0; z < height; z++) {
+						distances_sq[x * plane_size + offset + z] = buffer[(long int)z*length + x];
 					}
 				}
 			}
-			// Incrementing the expansion limit (d_current) one lattice unit at a time ensures that the shortest path to the interface is determined.
-			d_current += 1;
 		}
+	}
+
+	void Morphology::calculateInterfacialDistanceHistogram(const bool enable_chamfer_distances) {
 		// Clear existing interfacial distance histogram data
 		for (int n = 0; n < (int)Site_types.size(); n++) {
 			InterfacialHistogram_data[n].clear();
 		}
-		vector<int> counts((int)Site_types.size(), 0);
-		// Gather path data into separate vectors for each site type
+		// Gather the distances into separate vectors for each site type
+		// Distance data is rounded to the nearest integer lattice unit
 		vector<vector<int>> segmented_path_data(Site_types.size(), vector<int>());
-		for (int m = 0; m < (int)path_distances.size(); m++) {
-			for (int n = 0; n < (int)Site_types.size(); n++) {
-				if (lattice.getSiteType(m) == Site_types[n]) {
-					segmented_path_data[n].push_back(round_int(path_distances[m]));
-				}
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			segmented_path_data[n].reserve(Site_type_counts[n]);
+		}
+		// When the chamfer distances are enabled, the path distances through same type sites to the interface are calculated
+		if (enable_chamfer_distances) {
+			vector<float> path_distances;
+			calculateChamferInterfacialDistances(path_distances);
+			for (long int i = 0; i < lattice.getNumSites(); i++) {
+				segmented_path_data[getSiteTypeIndex(lattice.getSiteType(i))].push_back(round_int(path_distances[i]));
+			}
+		}
+		// Otherwise, the exact squared distance from each site to the nearest site of a different type is taken from the interfacial distance field
+		// Sites without any site of a different type in the lattice are given a distance of zero
+		else {
+			const vector<int>& distances_sq = getInterfacialDistanceField();
+			for (long int i = 0; i < lattice.getNumSites(); i++) {
+				int distance = (distances_sq[i] == Infinite_distance_sq) ? 0 : round_int(sqrt((double)distances_sq[i]));
+				segmented_path_data[getSiteTypeIndex(lattice.getSiteType(i))].push_back(distance);
 			}
 		}
-		// Path data is rounded to the nearest integer lattice unit
 		for (int n = 0; n < (int)Site_types.size(); n++) {
 			InterfacialHistogram_data[n] = calculateHist(segmented_path_data[n], 1);
 		}
 	}
 
 	double Morphology::calculateInterfacialVolumeFraction() const {
-		unsigned long site_count = 0;
-		Coords coords;
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
-				for (int z = 0; z < lattice.getHeight(); z++) {
-					coords.setXYZ(x, y, z);
-					if (isNearInterface(coords, 1.0)) {
-						site_count++;
-					}
-				}
-			}
-		}
+		const vector<int>& distances_sq = getInterfacialDistanceField();
+		long int site_count = count_if(distances_sq.begin(), distances_sq.end(), [](const int distance_sq) { return distance_sq <= 1; });
 		return (double)site_count / (double)lattice.getNumSites();
 	}
 
@@ -1046,367 +1768,642 @@ namespace Ising_OPV {
 		return counts;
 	}
 
-	bool Morphology::calculatePathDistances(vector<float>& path_distances) {
-		Coords coords;
+	void Morphology::calculateNeighborTypeCounts(const vector<char>& site_types, const int radius, const int cutoff_squared, vector<unsigned short>& type1_counts, vector<unsigned short>& type2_counts) const {
+		const int length = lattice.getLength();
+		const int width = lattice.getWidth();
+		const int height = lattice.getHeight();
+		const long plane_size = (long)width*height;
+		// Each z-line segment is given by its x and y offsets and the largest z offset within the cutoff radius.
+		vector<array<int, 3>> segments;
+		for (int i = -radius; i <= radius; i++) {
+			for (int j = -radius; j <= radius; j++) {
+				if (i*i + j * j > cutoff_squared) {
+					continue;
+				}
+				int k_max = 0;
+				while (k_max < radius && i*i + j * j + (k_max + 1)*(k_max + 1) <= cutoff_squared) {
+					k_max++;
+				}
+				segments.push_back({ i, j, k_max });
+			}
+		}
+		type1_counts.assign(site_types.size(), 0);
+		type2_counts.assign(site_types.size(), 0);
+#pragma omp parallel
+		{
+			vector<int> prefix1(height + 1, 0);
+			vector<int> prefix2(height + 1, 0);
+			// Calculates the number of sites from the start of the z-line up to position z, which may extend across the periodic z boundary.
+			auto get_prefix = [&](const vector<int>& prefix, const int z) {
+				if (z < 0) {
+					return prefix[z + height] - prefix[height];
+				}
+				if (z > height) {
+					return prefix[height] + prefix[z - height];
+				}
+				return prefix[z];
+			};
+#pragma omp for
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					const long column_index = x*plane_size + (long)y*height;
+					for (const auto& segment : segments) {
+						int x_dest = x + segment[0];
+						int y_dest = y + segment[1];
+						if (x_dest < 0 || x_dest >= length) {
+							if (!lattice.isXPeriodic()) {
+								continue;
+							}
+							x_dest += (x_dest < 0) ? length : -length;
+						}
+						if (y_dest < 0 || y_dest >= width) {
+							if (!lattice.isYPeriodic()) {
+								continue;
+							}
+							y_dest += (y_dest < 0) ? width : -width;
+						}
+						const long dest_column_index = x_dest*plane_size + (long)y_dest*height;
+						for (int z = 0; z < height; z++) {
+							prefix1[z + 1] = prefix1[z] + ((site_types[dest_column_index + z] == (char)1) ? 1 : 0);
+							prefix2[z + 1] = prefix2[z] + ((site_types[dest_column_index + z] == (char)2) ? 1 : 0);
+						}
+						for (int z = 0; z < height; z++) {
+							int z_min = z - segment[2];
+							int z_max = z + segment[2] + 1;
+							if (!lattice.isZPeriodic()) {
+								z_min = max(z_min, 0);
+								z_max = min(z_max, height);
+							}
+							int count1 = get_prefix(prefix1, z_max) - get_prefix(prefix1, z_min);
+							int count2 = get_prefix(prefix2, z_max) - get_prefix(prefix2, z_min);
+							// The site itself is not part of its neighborhood.
+							if (segment[0] == 0 && segment[1] == 0) {
+								if (site_types[column_index + z] == (char)1) {
+									count1--;
+								}
+								else if (site_types[column_index + z] == (char)2) {
+									count2--;
+								}
+							}
+							type1_counts[column_index + z] += (unsigned short)count1;
+							type2_counts[column_index + z] += (unsigned short)count2;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	bool Morphology::calculatePathDistances(vector<float>& path_distances, const vector<bool>& calc_types) {
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		long int N_sites = lattice.getNumSites();
+		bool periodic_x = lattice.isXPeriodic();
+		bool periodic_y = lattice.isYPeriodic();
 		long int current_index;
 		long int neighbor_index;
 		float d;
 		float d_temp;
-		const static float sqrt_two = sqrt((float)2.0);
-		const static float sqrt_three = sqrt((float)3.0);
-		// Create and initialize a blank node.
-		// Each node contains a vector with indices of all first- ,second-, and third-nearest neighbors (at most 26 neighbors).
-		// Another vector stores the squared distance to each of the neighbors.
-		// Each node also has an estimated distance from the destination.
-		Node temp_node;
-		// Create a node vector that is the same size as the lattice and initialize with blank nodes.
-		vector<Node> Node_vector;
-		Node_vector.assign(lattice.getNumSites(), temp_node);
-		// The neighbor_nodes set is sorted by the estimated distance of nodes in the set.
-		// This set is used in Dijsktra's algorithm to keep a sorted list of all nodes that are neighboring nodes that have their path distances already determined.
-		// Once the path distance for a particular node is fixed, all of its neighboring nodes that have not yet been fixed are added to the neighbor_nodes set.
-		set<vector<Node>::iterator, NodeIteratorCompare> neighbor_nodes;
-		vector<Node>::iterator current_it;
-		set<vector<Node>::iterator>::iterator current_set_it;
-		set<vector<Node>::iterator>::iterator set_it;
-		// Determine node connectivity.
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
-				for (int z = 0; z < lattice.getHeight(); z++) {
-					coords.setXYZ(x, y, z);
-					createNode(temp_node, coords);
-					Node_vector[lattice.getSiteIndex(x, y, z)] = temp_node;
+		float d_current;
+		const static float neighbor_distances[4] = { 0.0f, 1.0f, sqrt((float)2.0), sqrt((float)3.0) };
+		// The site types are copied to a contiguous array that is read while generating the neighbors of each node.
+		vector<char> site_types(N_sites);
+		for (long int i = 0; i < N_sites; i++) {
+			site_types[i] = lattice.getSiteType(i);
+		}
+		// Calculates the index of the neighbor of the site at (x,y,z) given by the specified stencil entry.
+		// Paths can cross the periodic x and y boundaries, but not the z boundaries.
+		// Returns -1 if the neighbor is outside of the lattice or is not the same type as the site.
+		auto get_neighbor_index = [&](const int x, const int y, const int z, const long int site_index, const NeighborOffset& offset) -> long int {
+			int z_dest = z + offset.k;
+			if (z_dest < 0 || z_dest >= height) {
+				return -1;
+			}
+			int x_dest = x + offset.i;
+			if (x_dest < 0 || x_dest >= length) {
+				if (!periodic_x) {
+					return -1;
 				}
+				x_dest += (x_dest < 0) ? length : -length;
 			}
-		}
+			int y_dest = y + offset.j;
+			if (y_dest < 0 || y_dest >= width) {
+				if (!periodic_y) {
+					return -1;
+				}
+				y_dest += (y_dest < 0) ? width : -width;
+			}
+			long int index = (long int)x_dest*width*height + (long int)y_dest*height + z_dest;
+			return (site_types[index] == site_types[site_index]) ? index : -1;
+		};
+		// The neighbor_nodes heap is keyed by the estimated distance of the nodes in the heap.
+		// This heap is used in Dijsktra's algorithm to keep track of all nodes that are neighboring nodes that have their path distances already determined.
+		// Once the path distance for a particular node is fixed, all of its neighboring nodes that have not yet been fixed are added to the neighbor_nodes heap.
+		IndexedMinHeap neighbor_nodes(N_sites);
 		// Initialize the path distances of top and bottom surfaces of the lattice.
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
+		for (int x = 0; x < length; x++) {
+			for (int y = 0; y < width; y++) {
 				if (lattice.getSiteType(x, y, 0) == Site_types[0]) {
 					path_distances[lattice.getSiteIndex(x, y, 0)] = 1;
 				}
-				if (lattice.getSiteType(x, y, lattice.getHeight() - 1) == Site_types[1]) {
-					path_distances[lattice.getSiteIndex(x, y, lattice.getHeight() - 1)] = 1;
+				if (lattice.getSiteType(x, y, height - 1) == Site_types[1]) {
+					path_distances[lattice.getSiteIndex(x, y, height - 1)] = 1;
 				}
 			}
 		}
 		// The pathfinding algorithm is performed for one domain type at a time.
 		int z;
 		for (int n = 0; n < 2; n++) {
+			if (!calc_types[n]) {
+				continue;
+			}
 			// Use Dijkstra's algorithm to fill in the remaining path distance data.
 			cout << ID << ": Executing Dijkstra's algorithm to calculate shortest paths through domain type " << (int)Site_types[n] << ".\n";
 			if (n == 0) {
 				z = 1;
 			}
 			else {
-				z = lattice.getHeight() - 2;
+				z = height - 2;
 			}
-			// Initialize the neighbor node set.
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					if (lattice.getSiteType(x, y, z) == Site_types[n]) {
+			// Initialize the neighbor node heap.
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					current_index = lattice.getSiteIndex(x, y, z);
+					if (site_types[current_index] == Site_types[n]) {
 						d = -1;
-						for (int i = 0; i < 26; i++) {
-							if (Node_vector[lattice.getSiteIndex(x, y, z)].neighbor_indices[i] < 0) {
-								break;
-							}
-							if (path_distances[Node_vector[lattice.getSiteIndex(x, y, z)].neighbor_indices[i]] > 0) {
-								d_temp = path_distances[Node_vector[lattice.getSiteIndex(x, y, z)].neighbor_indices[i]] + sqrt((float)(Node_vector[lattice.getSiteIndex(x, y, z)]).neighbor_distances_sq[i]);
+						for (const auto& offset : Neighbor_stencil) {
+							neighbor_index = get_neighbor_index(x, y, z, current_index, offset);
+							if (neighbor_index >= 0 && path_distances[neighbor_index] > 0) {
+								d_temp = path_distances[neighbor_index] + neighbor_distances[offset.distance_sq];
 								if (d < 0 || d_temp < d) {
 									d = d_temp;
 								}
 							}
 						}
 						if (d > 0) {
-							Node_vector[lattice.getSiteIndex(x, y, z)].distance_est = d;
-							neighbor_nodes.insert(Node_vector.begin() + lattice.getSiteIndex(x, y, z));
+							neighbor_nodes.push(current_index, d);
 						}
 					}
 				}
 			}
 			while (!neighbor_nodes.empty()) {
-				// The neighbor nodes set is sorted, so the first node has the shortest estimated path distance and is set to the current node.
-				current_set_it = neighbor_nodes.begin();
-				current_it = *current_set_it;
-				//current_index = (long)(current_it - Node_vector.begin());
-				current_index = (long int)distance(Node_vector.begin(), current_it);
-				// Insert neighbors of the current node into the neighbor node set.
-				for (int i = 0; i < 26; i++) {
-					if (Node_vector[current_index].neighbor_indices[i] < 0) {
-						break;
+				// The top node of the heap has the shortest estimated path distance and is set to the current node.
+				current_index = neighbor_nodes.getTopIndex();
+				d_current = neighbor_nodes.getTopKey();
+				// Finalize the path distance of current node and remove the current node from the neighbor node heap.
+				path_distances[current_index] = d_current;
+				neighbor_nodes.pop();
+				// Insert neighbors of the current node into the neighbor node heap.
+				int x_current = (int)(current_index / ((long int)width*height));
+				int y_current = (int)((current_index / height) % width);
+				int z_current = (int)(current_index % height);
+				for (const auto& offset : Neighbor_stencil) {
+					neighbor_index = get_neighbor_index(x_current, y_current, z_current, current_index, offset);
+					// Check that the target neighbor node is valid and has not already been finalized.
+					if (neighbor_index < 0 || path_distances[neighbor_index] > 0) {
+						continue;
+					}
+					// Insert the node into the heap if it is not already there or update its distance estimate if the new path distance estimate is smaller.
+					neighbor_nodes.push(neighbor_index, d_current + neighbor_distances[offset.distance_sq]);
+				}
+			}
+		}
+		return true;
+	}
+
+	bool Morphology::calculatePathDistances_OutOfCore(vector<float>& top_distances, vector<float>& bottom_distances) {
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		long int plane_size = (long int)length*width;
+		float d;
+		float d_current;
+		float d_neighbor;
+		Coords coords_dest;
+		const static float neighbor_distances[4] = { 0.0f, 1.0f, sqrt((float)2.0), sqrt((float)3.0) };
+		// The path distance of the site at (x,y,z) is stored at position z*Length*Width+x*Width+y of the scratch file, so that each z-plane is contiguous.
+		// Unvisited sites have a path distance of zero, and the path distance estimates of nodes in the neighbor node heap are stored as negative values until they are finalized.
+		ScratchFile scratch_file;
+		string filename = "tortuosity_scratch_" + to_string(ID) + ".tmp";
+		if (!scratch_file.open(filename, (size_t)lattice.getNumSites() * sizeof(float))) {
+			cout << ID << ": Error! Unable to create the tortuosity scratch file." << endl;
+			return false;
+		}
+		float* path_distances = (float*)scratch_file.data();
+		// Each entry of the neighbor node heap contains a path distance estimate and the scratch file position of the node.
+		// When a shorter path to a node is found, a new entry is added and the outdated entry is skipped when it reaches the top of the heap.
+		typedef pair<float, long int> HeapEntry;
+		priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>> neighbor_nodes;
+		// The number of heap entries in each z-plane is used to determine which planes are currently being accessed by the pathfinding front.
+		vector<long int> plane_counts(height, 0);
+		auto release_inactive_planes = [&]() {
+			int z_min = 0;
+			while (z_min < height && plane_counts[z_min] == 0) {
+				z_min++;
+			}
+			if (z_min == height) {
+				scratch_file.release(0, scratch_file.size());
+				return;
+			}
+			int z_max = height - 1;
+			while (plane_counts[z_max] == 0) {
+				z_max--;
+			}
+			// The neighbors of the nodes in the heap are up to one plane away.
+			z_min = max(z_min - 1, 0);
+			z_max = min(z_max + 1, height - 1);
+			scratch_file.release(0, z_min*plane_size * sizeof(float));
+			scratch_file.release((z_max + 1)*plane_size * sizeof(float), (height - 1 - z_max)*plane_size * sizeof(float));
+		};
+		// The pathfinding algorithm is performed for one domain type at a time.
+		for (int n = 0; n < 2; n++) {
+			cout << ID << ": Executing Dijkstra's algorithm to calculate shortest paths through domain type " << (int)Site_types[n] << ".\n";
+			int z_surface = (n == 0) ? 0 : height - 1;
+			int z_start = (n == 0) ? 1 : height - 2;
+			// Initialize the path distances of the surface sites.
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					if (lattice.getSiteType(x, y, z_surface) == Site_types[n]) {
+						path_distances[z_surface*plane_size + x*width + y] = 1;
 					}
-					neighbor_index = Node_vector[current_index].neighbor_indices[i];
-					// Check that the target neighbor node has not already been finalized.
-					if (path_distances[neighbor_index] > 0) {
+				}
+			}
+			// Initialize the neighbor node heap with the sites adjacent to the surface.
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					if (lattice.getSiteType(x, y, z_start) != Site_types[n]) {
 						continue;
 					}
-					// Calculate the estimated path distance.
-					//d = Node_vector[current_index].distance_est + sqrt((int)(Node_vector[current_index]).neighbor_distances_sq[i]);
-					switch (Node_vector[current_index].neighbor_distances_sq[i]) {
-					case 1:
-						d = Node_vector[current_index].distance_est + 1;
-						break;
-					case 2:
-						d = Node_vector[current_index].distance_est + sqrt_two;
-						break;
-					case 3:
-						d = Node_vector[current_index].distance_est + sqrt_three;
-						break;
-					default:
-						d = Node_vector[current_index].distance_est;
-						break;
+					d = -1;
+					for (const auto& offset : Neighbor_stencil) {
+						if (!calculatePathNeighborCoords(x, y, z_start, offset, coords_dest) || lattice.getSiteType(coords_dest.x, coords_dest.y, coords_dest.z) != Site_types[n]) {
+							continue;
+						}
+						d_neighbor = path_distances[coords_dest.z*plane_size + coords_dest.x*width + coords_dest.y];
+						if (d_neighbor > 0 && (d < 0 || d_neighbor + neighbor_distances[offset.distance_sq] < d)) {
+							d = d_neighbor + neighbor_distances[offset.distance_sq];
+						}
+					}
+					if (d > 0) {
+						path_distances[z_start*plane_size + x*width + y] = -d;
+						neighbor_nodes.push(make_pair(d, z_start*plane_size + x*width + y));
+						plane_counts[z_start]++;
+					}
+				}
+			}
+			long int N_popped = 0;
+			while (!neighbor_nodes.empty()) {
+				d_current = neighbor_nodes.top().first;
+				long int position = neighbor_nodes.top().second;
+				neighbor_nodes.pop();
+				int z_current = (int)(position / plane_size);
+				int x_current = (int)((position % plane_size) / width);
+				int y_current = (int)(position % width);
+				plane_counts[z_current]--;
+				if (++N_popped % plane_size == 0) {
+					release_inactive_planes();
+				}
+				// Skip outdated heap entries of nodes that have already been finalized.
+				if (path_distances[position] > 0) {
+					continue;
+				}
+				path_distances[position] = d_current;
+				for (const auto& offset : Neighbor_stencil) {
+					if (!calculatePathNeighborCoords(x_current, y_current, z_current, offset, coords_dest) || lattice.getSiteType(coords_dest.x, coords_dest.y, coords_dest.z) != Site_types[n]) {
+						continue;
 					}
-					// Check if node is already in the neighbor node set.
-					set_it = neighbor_nodes.find(Node_vector.begin() + neighbor_index);
-					// If the node is not already in the list, update the distance estimate for the target neighbor node and insert the node into the set.
-					if (set_it == neighbor_nodes.end()) {
-						Node_vector[neighbor_index].distance_est = d;
-						neighbor_nodes.insert(Node_vector.begin() + neighbor_index);
+					long int neighbor_position = coords_dest.z*plane_size + coords_dest.x*width + coords_dest.y;
+					d_neighbor = path_distances[neighbor_position];
+					d = d_current + neighbor_distances[offset.distance_sq];
+					// Skip finalized nodes and nodes that already have a shorter or equal path distance estimate.
+					if (d_neighbor > 0 || (d_neighbor < 0 && -d_neighbor <= d)) {
+						continue;
 					}
-					// If it already is in the list, replace it only if the new path distance estimate is smaller.
-					else if (d < (*set_it)->distance_est) {
-						neighbor_nodes.erase(set_it);
-						Node_vector[neighbor_index].distance_est = d;
-						neighbor_nodes.insert(Node_vector.begin() + neighbor_index);
+					path_distances[neighbor_position] = -d;
+					neighbor_nodes.push(make_pair(d, neighbor_position));
+					plane_counts[coords_dest.z]++;
+				}
+			}
+			release_inactive_planes();
+		}
+		// Copy the path distances of the top and bottom surfaces.
+		top_distances.assign(plane_size, 0);
+		bottom_distances.assign(plane_size, 0);
+		copy(path_distances + (height - 1)*plane_size, path_distances + height*plane_size, top_distances.begin());
+		copy(path_distances, path_distances + plane_size, bottom_distances.begin());
+		// Any sites that were not reached are part of island domains.
+		// The scratch file is read one plane at a time, and each plane is released once it has been counted.
+		Island_volume.assign((int)Site_types.size(), 0);
+		for (int z = 0; z < height; z++) {
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					if (path_distances[z*plane_size + x*width + y] < 1) {
+						char site_type = lattice.getSiteType(x, y, z);
+						if (site_type == Site_types[0]) {
+							Island_volume[0]++;
+						}
+						else if (site_type == Site_types[1]) {
+							Island_volume[1]++;
+						}
 					}
 				}
-				// Finalize the path distance of current node and remove the current node from the neighbor node set.
-				path_distances[current_index] = Node_vector[current_index].distance_est;
-				neighbor_nodes.erase(current_set_it);
 			}
+			scratch_file.release(z*plane_size * sizeof(float), plane_size * sizeof(float));
 		}
-		// Clear allocated memory for the neighbor nodes set
-		set<vector<Node>::iterator, NodeIteratorCompare>().swap(neighbor_nodes);
 		return true;
 	}
 
-	bool Morphology::calculatePathDistances_ReducedMemory(vector<float>& path_distances) {
+	bool Morphology::calculatePathDistances_ReducedMemory(vector<float>& path_distances, const vector<bool>& calc_types) {
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
 		float d;
-		float d_temp;
-		Coords coords;
-		const static float sqrt_two = sqrt((float)2.0);
-		const static float sqrt_three = sqrt((float)3.0);
-		// Create a temporary node to be used throughout the function.
-		// Each node contains a vector with indices of all first- ,second-, and third-nearest neighbors (at most 26 neighbors).
-		// Another vector stores the squared distance to each of the neighbors.
-		// Each node also has an estimated distance from the destination and the site index.
-		Node temp_node;
-		// Create Node vector to store neighbor nodes
-		// This vector is used in Dijsktra's algorithm to keep a list of all nodes that are neighboring sites that already have their path distances determined.
-		// Once the path distance for a particular node is finalized, it is removed from the neighbor node vector and
-		// all of its neighboring nodes that have not yet been finalized are added to the neighbor node vector.
-		vector<Node> Node_vector;
-		int Node_vector_count = 0;
-		long int node_index = -1;
-		long int current_index = -1;
-		long int neighbor_index = -1;
-		// Create a boolean vector that keeps track of whether or not nodes have already been added to the node vector
-		vector<bool> added;
-		added.assign(lattice.getNumSites(), false);
-		int z;
+		float d_current;
+		float d_neighbor;
+		long int current_index;
+		long int neighbor_index;
+		Coords coords_dest;
+		const static float neighbor_distances[4] = { 0.0f, 1.0f, sqrt((float)2.0), sqrt((float)3.0) };
+		// Unvisited sites have a path distance of zero, and the path distance estimates of nodes in the neighbor node heap are stored as negative values until they are finalized.
+		// Each entry of the neighbor node heap contains a path distance estimate and a site index.
+		// When a shorter path to a node is found, a new entry is added and the outdated entry is skipped when it reaches the top of the heap,
+		// so no per-site heap data is needed and the heap size only depends on the size of the pathfinding front.
+		typedef pair<float, long int> HeapEntry;
+		priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry>> neighbor_nodes;
 		// The pathfinding algorithm is performed for one domain type at a time.
 		for (int n = 0; n < 2; n++) {
+			if (!calc_types[n]) {
+				continue;
+			}
 			// Use Dijkstra's algorithm to fill in the remaining path distance data.
 			cout << ID << ": Executing Dijkstra's algorithm to calculate shortest paths through domain type " << (int)Site_types[n] << "." << endl;
-			// Clear Node vector
-			Node_vector.clear();
-			Node_vector.assign(lattice.getLength()*lattice.getWidth(), temp_node);
+			int z_surface = (n == 0) ? 0 : height - 1;
+			int z_start = (n == 0) ? 1 : height - 2;
 			// Initialize the path distances with known values
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					if (n == 0 && lattice.getSiteType(x, y, 0) == Site_types[n]) {
-						path_distances[lattice.getSiteIndex(x, y, 0)] = 1;
-						added[lattice.getSiteIndex(x, y, 0)] = true;
-					}
-					if (n == 1 && lattice.getSiteType(x, y, lattice.getHeight() - 1) == Site_types[n]) {
-						path_distances[lattice.getSiteIndex(x, y, lattice.getHeight() - 1)] = 1;
-						added[lattice.getSiteIndex(x, y, lattice.getHeight() - 1)] = true;
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					if (lattice.getSiteType(x, y, z_surface) == Site_types[n]) {
+						path_distances[lattice.getSiteIndex(x, y, z_surface)] = 1;
 					}
 				}
 			}
-			// Initialize the neighbor node vector.
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					if (n == 0) {
-						z = 1;
-					}
-					else if (n == 1) {
-						z = lattice.getHeight() - 2;
-					}
-					else {
+			// Initialize the neighbor node heap.
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					if (lattice.getSiteType(x, y, z_start) != Site_types[n]) {
 						continue;
 					}
-					if (lattice.getSiteType(x, y, z) == Site_types[n]) {
-						d = -1;
-						coords.setXYZ(x, y, z);
-						createNode(temp_node, coords);
-						for (int i = 0; i < 26; i++) {
-							neighbor_index = temp_node.neighbor_indices[i];
-							if (neighbor_index < 0) {
-								break;
-							}
-							if (path_distances[neighbor_index] > 0) {
-								d_temp = path_distances[neighbor_index] + sqrt((float)temp_node.neighbor_distances_sq[i]);
-								if (d < 0 || d_temp < d) {
-									d = d_temp;
-								}
-							}
+					d = -1;
+					for (const auto& offset : Neighbor_stencil) {
+						if (!calculatePathNeighborCoords(x, y, z_start, offset, coords_dest) || lattice.getSiteType(coords_dest.x, coords_dest.y, coords_dest.z) != Site_types[n]) {
+							continue;
 						}
-						if (d > 0) {
-							temp_node.distance_est = d;
-							Node_vector[Node_vector_count] = temp_node;
-							Node_vector_count++;
-							added[temp_node.site_index] = true;
+						d_neighbor = path_distances[lattice.getSiteIndex(coords_dest.x, coords_dest.y, coords_dest.z)];
+						if (d_neighbor > 0 && (d < 0 || d_neighbor + neighbor_distances[offset.distance_sq] < d)) {
+							d = d_neighbor + neighbor_distances[offset.distance_sq];
 						}
 					}
+					if (d > 0) {
+						current_index = lattice.getSiteIndex(x, y, z_start);
+						path_distances[current_index] = -d;
+						neighbor_nodes.push(make_pair(d, current_index));
+					}
 				}
 			}
-			// The pathfinding algorithm proceeds until there are no nodes left in the neighbor node vector.
-			while (!Node_vector_count == 0) {
-				// Identify the node with the shortest estimated path distance as the current node.
-				d_temp = -1;
-				for (int i = 0; i < Node_vector_count; i++) {
-					if (d_temp < 0 || Node_vector[i].distance_est < d_temp) {
-						current_index = i;
-						d_temp = Node_vector[i].distance_est;
-					}
+			// The pathfinding algorithm proceeds until there are no nodes left in the neighbor node heap.
+			while (!neighbor_nodes.empty()) {
+				// The top node of the heap has the shortest estimated path distance and is set to the current node.
+				d_current = neighbor_nodes.top().first;
+				current_index = neighbor_nodes.top().second;
+				neighbor_nodes.pop();
+				// Skip outdated heap entries of nodes that have already been finalized.
+				if (path_distances[current_index] > 0) {
+					continue;
 				}
-				// Insert any unfinalized neighbors of the current node into the neighbor node vector, and check if any already added nodes need to be updated.
-				for (int i = 0; i < 26; i++) {
-					neighbor_index = Node_vector[current_index].neighbor_indices[i];
-					// Check if the target neighbor node is valid.
-					if (neighbor_index < 0) {
-						break;
+				// Finalize the path distance of current node.
+				path_distances[current_index] = d_current;
+				// Insert any unfinalized neighbors of the current node into the neighbor node heap.
+				int x_current = (int)(current_index / ((long int)width*height));
+				int y_current = (int)((current_index / height) % width);
+				int z_current = (int)(current_index % height);
+				for (const auto& offset : Neighbor_stencil) {
+					if (!calculatePathNeighborCoords(x_current, y_current, z_current, offset, coords_dest) || lattice.getSiteType(coords_dest.x, coords_dest.y, coords_dest.z) != Site_types[n]) {
+						continue;
 					}
-					// Check if the target neighbor node has been finalized.
-					else if (!(path_distances[neighbor_index] > 0)) {
-						// Calculate the estimated path distance to the target neighbor node.
-						switch (Node_vector[current_index].neighbor_distances_sq[i]) {
-						case 1:
-							d = Node_vector[current_index].distance_est + 1;
-							break;
-						case 2:
-							d = Node_vector[current_index].distance_est + sqrt_two;
-							break;
-						case 3:
-							d = Node_vector[current_index].distance_est + sqrt_three;
-							break;
-						default:
-							d = Node_vector[current_index].distance_est;
-							break;
-						}
-						// Check if the target neighbor node has already been added to the Node vector.
-						// If not, create the node, update the distance estimate, and add it to the Node vector.
-						if (!added[neighbor_index]) {
-							coords = lattice.getSiteCoords(neighbor_index);
-							createNode(temp_node, coords);
-							temp_node.distance_est = d;
-							if (Node_vector_count < (int)Node_vector.size()) {
-								Node_vector[Node_vector_count] = temp_node;
-								Node_vector_count++;
-							}
-							else {
-								Node_vector.push_back(temp_node);
-								Node_vector_count++;
-							}
-							added[neighbor_index] = true;
-						}
-						// If it has already been added to the node vector, find it, and update the distance estimate only if the new path distance estimate is smaller.
-						else {
-							// Find the location of the target neighbor node in the node vector
-							node_index = -1;
-							for (int j = 0; j < Node_vector_count; j++) {
-								if (Node_vector[j].site_index == neighbor_index) {
-									node_index = j;
-									break;
-								}
-							}
-							if (node_index < 0) {
-								cout << ID << ": Error! A node designated as added could not be found in the node vector." << endl;
-								return false;
-							}
-							// Update the distance estimate of the neighbor node if a shorter path has been located.
-							if (d < Node_vector[node_index].distance_est) {
-								Node_vector[node_index].distance_est = d;
-							}
-						}
+					neighbor_index = lattice.getSiteIndex(coords_dest.x, coords_dest.y, coords_dest.z);
+					d_neighbor = path_distances[neighbor_index];
+					d = d_current + neighbor_distances[offset.distance_sq];
+					// Skip finalized nodes and nodes that already have a shorter or equal path distance estimate.
+					if (d_neighbor > 0 || (d_neighbor < 0 && -d_neighbor <= d)) {
+						continue;
 					}
+					path_distances[neighbor_index] = -d;
+					neighbor_nodes.push(make_pair(d, neighbor_index));
 				}
-				// Finalize the path distance of current node and remove it from the neighbor node vector.
-				path_distances[Node_vector[current_index].site_index] = Node_vector[current_index].distance_est;
-				Node_vector[current_index] = Node_vector[Node_vector_count - 1];
-				Node_vector_count--;
 			}
 		}
 		return true;
 	}
 
-	bool Morphology::calculateTortuosity(const char site_type, const bool enable_reduced_memory) {
-		bool success;
-		bool electrode_num;
-		if (site_type == (char)1) {
-			electrode_num = false;
+	bool Morphology::calculatePathNeighborCoords(const int x, const int y, const int z, const NeighborOffset& offset, Coords& coords_dest) const {
+		coords_dest.z = z + offset.k;
+		if (coords_dest.z < 0 || coords_dest.z >= lattice.getHeight()) {
+			return false;
+		}
+		coords_dest.x = x + offset.i;
+		if (coords_dest.x < 0 || coords_dest.x >= lattice.getLength()) {
+			if (!lattice.isXPeriodic()) {
+				return false;
+			}
+			coords_dest.x += (coords_dest.x < 0) ? lattice.getLength() : -lattice.getLength();
 		}
-		else if (site_type == (char)2) {
-			electrode_num = true;
+		coords_dest.y = y + offset.j;
+		if (coords_dest.y < 0 || coords_dest.y >= lattice.getWidth()) {
+			if (!lattice.isYPeriodic()) {
+				return false;
+			}
+			coords_dest.y += (coords_dest.y < 0) ? lattice.getWidth() : -lattice.getWidth();
 		}
-		else {
+		return true;
+	}
+
+	void Morphology::calculateResamplingTable(const int N_out, const double unit_size, const int N_in, const double unit_size_i, const int order, ResamplingTable& table) const {
+		table.N_taps = (order == 3) ? 4 : 2;
+		table.indices.assign((size_t)N_out*table.N_taps, 0);
+		table.weights.assign((size_t)N_out*table.N_taps, 0.0);
+		for (int n = 0; n < N_out; n++) {
+			// Determine the output position in units of the input lattice and its fractional offset from the preceding input site
+			double position = (n * unit_size) / unit_size_i;
+			int index = (int)floor(position);
+			double t = position - index;
+			size_t m = (size_t)n*table.N_taps;
+			if (table.N_taps == 2) {
+				table.weights[m] = 1.0 - t;
+				table.weights[m + 1] = t;
+			}
+			else {
+				table.weights[m] = 0.5*(-t * t*t + 2 * t*t - t);
+				table.weights[m + 1] = 0.5*(3 * t*t*t - 5 * t*t + 2);
+				table.weights[m + 2] = 0.5*(-3 * t*t*t + 4 * t*t + t);
+				table.weights[m + 3] = 0.5*(t*t*t - t * t);
+				index--;
+			}
+			for (int tap = 0; tap < table.N_taps; tap++) {
+				table.indices[m + tap] = max(0, min(index + tap, N_in - 1));
+			}
+		}
+	}
+
+	bool Morphology::calculateTortuosities(const bool enable_reduced_memory, const bool enable_out_of_core) {
+		return calculateTortuosityData(vector<bool>(2, true), enable_reduced_memory, enable_out_of_core);
+	}
+
+	bool Morphology::calculateTortuosity(const char site_type, const bool enable_reduced_memory) {
+		if (site_type != (char)1 && site_type != (char)2) {
 			cout << ID << ": Error! Tortuosity can only be calculated for site types 1 and 2." << endl;
 			return false;
 		}
-		// The shortest path for each site is stored in the path_distances vector.
-		// The path distances are initialized to -1.
-		vector<float> path_distances(lattice.getNumSites(), -1.0);
-		int site_type_index = getSiteTypeIndex(site_type);
-		// Two different path distance calculation implementations are available.
+		vector<bool> calc_types(2, false);
+		calc_types[getSiteTypeIndex(site_type)] = true;
+		return calculateTortuosityData(calc_types, enable_reduced_memory, false);
+	}
+
+	bool Morphology::calculateTortuosityData(const vector<bool>& calc_types, const bool enable_reduced_memory, const bool enable_out_of_core) {
+		bool success;
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		// The end-to-end tortuosity is calculated from the path distances of the sites on the top surface (z=Height-1) and the bottom surface (z=0).
+		// The surface path distances are stored in vectors indexed by Width*x+y.
+		vector<float> top_distances;
+		vector<float> bottom_distances;
+		// Three different path distance calculation implementations are available.
 		// The reduced memory implementation uses less memory but takes more calculation time.
 		// It is designed to be used when creating large lattices to prevent running out of system memory.
-		if (enable_reduced_memory) {
-			success = calculatePathDistances_ReducedMemory(path_distances);
+		// The out-of-core implementation stores the path distances in a scratch file and only keeps the data near the pathfinding front in memory.
+		// It is designed to be used when the path distance data of the lattice does not fit in the system memory.
+		// The standard and reduced memory implementations only calculate the path distances of the enabled site types, while the out-of-core implementation always calculates both site types in one pass.
+		if (enable_out_of_core) {
+			success = calculatePathDistances_OutOfCore(top_distances, bottom_distances);
 		}
 		else {
-			success = calculatePathDistances(path_distances);
-		}
-		if (!success) {
-			cout << ID << ": Error calculating path distances!" << endl;
-			return false;
-		}
-		// The end-to-end tortuosity describes the tortuosities for the all pathways from the top surface to the bottom surface of the lattice.
-		int index;
-		Tortuosity_data[site_type_index].assign(lattice.getLength()*lattice.getWidth(), -1);
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
-				index = lattice.getWidth()*x + y;
-				if (!electrode_num) {
-					if (lattice.getSiteType(x, y, lattice.getHeight() - 1) == site_type && path_distances[lattice.getSiteIndex(x, y, lattice.getHeight() - 1)] > 0) {
-						Tortuosity_data[site_type_index][index] = (double)path_distances[lattice.getSiteIndex(x, y, lattice.getHeight() - 1)] / (double)lattice.getHeight();
-					}
+			for (int n = 0; n < 2; n++) {
+				if (calc_types[n]) {
+					Island_volume[n] = 0;
 				}
-				else {
-					if (lattice.getSiteType(x, y, 0) == site_type && path_distances[lattice.getSiteIndex(x, y, 0)] > 0) {
-						Tortuosity_data[site_type_index][index] = (double)path_distances[lattice.getSiteIndex(x, y, 0)] / (double)lattice.getHeight();
+			}
+			// The shortest path for each site is stored in the path_distances vector.
+			// The path distances are initialized to zero.
+			vector<float> path_distances(lattice.getNumSites(), 0.0f);
+			if (enable_reduced_memory) {
+				// The reduced memory implementation does not label the domains, because the labels would need more memory than the path distance data.
+				// Instead, any sites that are not reached by the pathfinding are identified as part of island domains.
+				success = calculatePathDistances_ReducedMemory(path_distances, calc_types);
+				if (success) {
+					for (long int i = 0; i < lattice.getNumSites(); i++) {
+						for (int n = 0; n < 2; n++) {
+							if (calc_types[n] && lattice.getSiteType(i) == Site_types[n] && path_distances[i] < 1) {
+								Island_volume[n]++;
+							}
+						}
 					}
 				}
 			}
-		}
-		// Any sites which are not connected their respective surface, will have a zero path distance and are identified as part of island domains.
-		// Calculate island volume fraction
-		Island_volume.assign((int)Site_types.size(), 0);
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
-				for (int z = 0; z < lattice.getHeight(); z++) {
-					if (lattice.getSiteType(x, y, z) == Site_types[0] && path_distances[lattice.getSiteIndex(x, y, z)] < 1) {
-						Island_volume[0]++;
+			else {
+				// Any sites which are not connected to their respective surface are identified as part of island domains.
+				// The domains are labeled using the same 26-neighbor connectivity as the pathfinding, and the pathfinding is skipped for site types that do not percolate,
+				// because none of the paths through these site types can reach the opposite surface.
+				vector<bool> percolating_types(2, false);
+				for (const auto& domain : calculateDomainData(3)) {
+					for (int n = 0; n < 2; n++) {
+						if (!calc_types[n] || domain.site_type != Site_types[n]) {
+							continue;
+						}
+						if (!(n == 0 ? domain.is_bottom_connected : domain.is_top_connected)) {
+							Island_volume[n] += domain.volume;
+						}
+						if (domain.is_bottom_connected && domain.is_top_connected) {
+							percolating_types[n] = true;
+						}
 					}
-					if (lattice.getSiteType(x, y, z) == Site_types[1] && path_distances[lattice.getSiteIndex(x, y, z)] < 1) {
-						Island_volume[1]++;
+				}
+				for (int n = 0; n < 2; n++) {
+					if (calc_types[n] && !percolating_types[n]) {
+						cout << ID << ": Domain type " << (int)Site_types[n] << " does not percolate, so no paths through it reach the opposite surface." << endl;
 					}
 				}
+				success = calculatePathDistances(path_distances, percolating_types);
+			}
+			if (success) {
+				top_distances.assign((long int)length*width, 0);
+				bottom_distances.assign((long int)length*width, 0);
+				for (int x = 0; x < length; x++) {
+					for (int y = 0; y < width; y++) {
+						top_distances[width*x + y] = path_distances[lattice.getSiteIndex(x, y, height - 1)];
+						bottom_distances[width*x + y] = path_distances[lattice.getSiteIndex(x, y, 0)];
+					}
+				}
+			}
+		}
+		if (!success) {
+			cout << ID << ": Error calculating path distances!" << endl;
+			return false;
+		}
+		// The end-to-end tortuosity describes the tortuosities for the all pathways from the top surface to the bottom surface of the lattice.
+		// Type 1 paths start at z=0 and end at the top surface, and type 2 paths start at z=Height-1 and end at the bottom surface.
+		int index;
+		for (int n = 0; n < 2; n++) {
+			if (calc_types[n]) {
+				Tortuosity_data[n].assign(length*width, -1);
+			}
+		}
+		for (int x = 0; x < length; x++) {
+			for (int y = 0; y < width; y++) {
+				index = width*x + y;
+				if (calc_types[0] && lattice.getSiteType(x, y, height - 1) == Site_types[0] && top_distances[index] > 0) {
+					Tortuosity_data[0][index] = (double)top_distances[index] / (double)height;
+				}
+				if (calc_types[1] && lattice.getSiteType(x, y, 0) == Site_types[1] && bottom_distances[index] > 0) {
+					Tortuosity_data[1][index] = (double)bottom_distances[index] / (double)height;
+				}
 			}
 		}
 		return true;
 	}
 
+	void Morphology::classifyTomogramBrick(const TomogramData& tomogram_data, const vector<float>& brick, const int z_start, const int z_end, vector<long int>& tie_counts, const function<void(const int, const int, const int, const char)>& site_function) const {
+		const int length = tomogram_data.lattice_params.Length;
+		const int width = tomogram_data.lattice_params.Width;
+		const int brick_height = z_end - z_start;
+		// The sites are classified one z-plane at a time, so that the classification order does not depend on the brick height
+		for (int k = z_start; k < z_end; k++) {
+			for (int i = 0; i < length; i++) {
+				for (int j = 0; j < width; j++) {
+					unsigned int key = getBrightnessKey(brick[((size_t)i*width + j)*brick_height + (k - z_start)]);
+					bool is_below[2];
+					for (int n = 0; n < 2; n++) {
+						is_below[n] = (key < tomogram_data.threshold_keys[n]);
+						// Sites with the threshold key are below the threshold until the number of ties below the threshold has been reached
+						if (key == tomogram_data.threshold_keys[n]) {
+							is_below[n] = (tie_counts[n] < tomogram_data.N_threshold_ties[n]);
+							tie_counts[n]++;
+						}
+					}
+					if (is_below[0]) {
+						site_function(i, j, k, (char)2);
+					}
+					else if (!is_below[1]) {
+						site_function(i, j, k, (char)1);
+					}
+					else {
+						site_function(i, j, k, (char)0);
+					}
+				}
+			}
+		}
+	}
+
 	//void Morphology::enableThirdNeighborInteraction() {
 	//	Enable_third_neighbor_interaction = true;
 	//}
@@ -1469,22 +2466,18 @@ namespace Ising_OPV {
 		}
 		node.site_index = lattice.getSiteIndex(coords);
 		int neighbor_count = 0;
-		for (int i = -1; i <= 1; i++) {
-			for (int j = -1; j <= 1; j++) {
-				for (int k = -1; k <= 1; k++) {
-					if (!lattice.checkMoveValidity(coords, i, j, k)) {
-						continue;
-					}
-					if (coords.z + k < 0 || coords.z + k >= lattice.getHeight()) {
-						continue;
-					}
-					lattice.calculateDestinationCoords(coords, i, j, k, coords_dest);
-					if (lattice.getSiteType(coords) == lattice.getSiteType(coords_dest)) {
-						node.neighbor_indices[neighbor_count] = lattice.getSiteIndex(coords_dest);
-						node.neighbor_distances_sq[neighbor_count] = (char)(i*i + j * j + k * k);
-						neighbor_count++;
-					}
-				}
+		for (const auto& offset : Neighbor_stencil) {
+			if (!lattice.checkMoveValidity(coords, offset.i, offset.j, offset.k)) {
+				continue;
+			}
+			if (coords.z + offset.k < 0 || coords.z + offset.k >= lattice.getHeight()) {
+				continue;
+			}
+			lattice.calculateDestinationCoords(coords, offset.i, offset.j, offset.k, coords_dest);
+			if (lattice.getSiteType(coords) == lattice.getSiteType(coords_dest)) {
+				node.neighbor_indices[neighbor_count] = lattice.getSiteIndex(coords_dest);
+				node.neighbor_distances_sq[neighbor_count] = (char)offset.distance_sq;
+				neighbor_count++;
 			}
 		}
 	}
@@ -1597,16 +2590,11 @@ namespace Ising_OPV {
 	}
 
 	void Morphology::executeMixing(const double interfacial_width, const double interfacial_conc) {
-		vector<int> sites_maj;
-		vector<int> sites_min;
-		int site_maj;
-		int site_min;
-		int target;
-		int site_count = 0;
+		vector<long int> sites_maj;
+		vector<long int> sites_min;
 		char majority_type;
 		char minority_type;
 		double minority_conc;
-		Coords coords;
 		// Based on the interfacial concentration, the majority and minority types are defined
 		if (interfacial_conc <= 0.5) {
 			majority_type = (char)2;
@@ -1618,120 +2606,315 @@ namespace Ising_OPV {
 			minority_type = (char)2;
 			minority_conc = 1 - interfacial_conc;
 		}
+		// Both reservoirs are determined from the distance of each site to the nearest site of a different type in the interfacial distance field.
+		const vector<int>& distances_sq = getInterfacialDistanceField();
+		const long int N_sites = (long int)lattice.getNumSites();
 		// The minority type sites are mixed into the majority type sites at the interface.
-		// First the majority site reservoir is determined by finding all majority type sites within (1-minority_conc)*width distance from the interface and adding them to a list
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
-				for (int z = 0; z < lattice.getHeight(); z++) {
-					coords.setXYZ(x, y, z);
-					if (lattice.getSiteType(x, y, z) == majority_type) {
-						if (isNearInterface(coords, (1 - minority_conc)*interfacial_width)) {
-							sites_maj.push_back(lattice.getSiteIndex(x, y, z));
-							site_count++;
-						}
-					}
+		// The majority site reservoir is determined by finding all majority type sites within (1-minority_conc)*width distance from the interface and adding them to a list.
+		// At the same time, a histogram of the squared distances of the minority type sites is constructed.
+		const double majority_range = (1 - minority_conc)*interfacial_width;
+		vector<long int> minority_counts;
+		for (long int n = 0; n < N_sites; n++) {
+			if (distances_sq[n] == Infinite_distance_sq) {
+				continue;
+			}
+			if (lattice.getSiteType(n) == majority_type) {
+				if ((double)distances_sq[n] <= majority_range * majority_range) {
+					sites_maj.push_back(n);
 				}
 			}
+			else if (lattice.getSiteType(n) == minority_type) {
+				if (distances_sq[n] >= (int)minority_counts.size()) {
+					minority_counts.resize(distances_sq[n] + 1, 0);
+				}
+				minority_counts[distances_sq[n]]++;
+			}
 		}
+		long int site_count = (long int)sites_maj.size();
 		// Then the minority site reservoir that will be used to be mix into the majority reservoir to yield the desired final interfacial concentration is determined
 		// More minority sites than the number of swaps must be included in the minority reservoir so that the desired interfacial concentration is also reached on the minority side of the interface.
-		target = (int)(site_count*minority_conc / (1 - minority_conc));
-		int N = 0;
-		double range = 1;
-		// The minority type sites adjacent to the interface are identified, counted, and added to a list.
+		long int target = (long int)(site_count*minority_conc / (1 - minority_conc));
+		// The minority type sites adjacent to the interface are included first.
 		// If this does not yield enough minority sites for swapping, then the range is slowly incremented and minority sites farther from the interface are included until there are enough sites.
-		while (N < target) {
-			sites_min.clear();
-			N = 0;
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					for (int z = 0; z < lattice.getHeight(); z++) {
-						coords.setXYZ(x, y, z);
-						if (lattice.getSiteType(x, y, z) == minority_type) {
-							if (isNearInterface(coords, range)) {
-								sites_min.push_back(lattice.getSiteIndex(x, y, z));
-								N++;
-							}
-						}
-					}
-				}
+		// The number of sites within each range is found from the cumulative histogram instead of rescanning the lattice.
+		partial_sum(minority_counts.begin(), minority_counts.end(), minority_counts.begin());
+		double range = 1;
+		int minority_cutoff_sq = 0;
+		while (!minority_counts.empty()) {
+			minority_cutoff_sq = (int)min(floor(range*range), (double)(minority_counts.size() - 1));
+			if (minority_counts[minority_cutoff_sq] >= target || minority_cutoff_sq == (int)minority_counts.size() - 1) {
+				break;
 			}
 			range += 0.1;
 		}
+		for (long int n = 0; n < N_sites; n++) {
+			if (distances_sq[n] <= minority_cutoff_sq && lattice.getSiteType(n) == minority_type) {
+				sites_min.push_back(n);
+			}
+		}
 		// Sites are randomly chosen from the minority and majority reservoirs and swapped until the desired interfacial concentration is reached.
-		for (int i = 0; i < site_count*minority_conc; i++) {
-			uniform_int_distribution<int> dist_maj(0, (int)sites_maj.size() - 1);
-			auto rand_maj = bind(dist_maj, ref(gen));
-			uniform_int_distribution<int> dist_min(0, (int)sites_min.size() - 1);
-			auto rand_min = bind(dist_min, ref(gen));
-			site_maj = rand_maj();
-			site_min = rand_min();
-			lattice.setSiteType(sites_maj[site_maj], minority_type);
-			lattice.setSiteType(sites_min[site_min], majority_type);
-			// Both site types are removed from the lists once they are swapped to prevent unswapping.
-			sites_maj.erase(sites_maj.begin() + site_maj);
-			sites_min.erase(sites_min.begin() + site_min);
-		}
-	}
-
-	void Morphology::executeSmoothing(const double smoothing_threshold, const int rescale_factor) {
-		double roughness_factor;
-		Coords coords, coords_dest;
+		// Each reservoir is partially shuffled with the Fisher-Yates algorithm, so that the chosen sites are moved to the front of the list and cannot be chosen again to be unswapped.
+		long int N_swaps = (long int)ceil(site_count*minority_conc);
+		if (N_swaps > (long int)sites_min.size()) {
+			N_swaps = (long int)sites_min.size();
+		}
+		for (long int i = 0; i < N_swaps; i++) {
+			uniform_int_distribution<long int> dist_maj(i, (long int)sites_maj.size() - 1);
+			uniform_int_distribution<long int> dist_min(i, (long int)sites_min.size() - 1);
+			swap(sites_maj[i], sites_maj[dist_maj(gen)]);
+			swap(sites_min[i], sites_min[dist_min(gen)]);
+			lattice.setSiteType(sites_maj[i], minority_type);
+			lattice.setSiteType(sites_min[i], majority_type);
+		}
+	}
+
+	void Morphology::executeSmoothing(const double smoothing_threshold, const int rescale_factor, const bool enable_parallel) {
+		const int length = lattice.getLength();
+		const int width = lattice.getWidth();
+		const int height = lattice.getHeight();
+		const long num_sites = (long)lattice.getNumSites();
+		const long plane_size = (long)width*height;
+		const bool periodic_x = lattice.isXPeriodic();
+		const bool periodic_y = lattice.isYPeriodic();
+		const bool periodic_z = lattice.isZPeriodic();
+		// When the rescale factor is 1, the radius is 1, and the radius increases for larger rescale factors.
 		int radius = (rescale_factor <= 2) ? 1 : (int)ceil((double)(rescale_factor + 1) / 2);
 		int cutoff_squared = (rescale_factor <= 2) ? 2 : (int)floor(intpow((rescale_factor + 1.0) / 2.0, 2));
-		// The boolean vector consider_smoothing keeps track of whether each site is near the interface and should be considered for smoothing.
-		// Sites in the interior of the domains or at very smooth interfaces do not need to be continually reconsidered for smoothing.
-		vector<bool> consider_smoothing;
-		consider_smoothing.assign(lattice.getNumSites(), true);
-		int site_count = 1;
-		while (site_count > 0) {
-			site_count = 0;
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					for (int z = 0; z < lattice.getHeight(); z++) {
-						if (!consider_smoothing[lattice.getSiteIndex(x, y, z)]) {
-							continue;
-						}
-						coords.setXYZ(x, y, z);
-						// Calculate the roughness factor of the target site.
-						roughness_factor = calculateDissimilarFraction(coords, rescale_factor);
-						// Swap the site's type if the roughness_factor is greater than the smoothing_threshold.
-						if (roughness_factor > smoothing_threshold) {
-							if (lattice.getSiteType(x, y, z) == (char)1) {
-								lattice.setSiteType(x, y, z, (char)2);
-							}
-							else if (lattice.getSiteType(x, y, z) == (char)2) {
-								lattice.setSiteType(x, y, z, (char)1);
-							}
-							site_count++;
-							// When a site swaps types, all surrounding sites must be reconsidered for smoothing.
-							for (int i = -radius; i <= radius; i++) {
-								for (int j = -radius; j <= radius; j++) {
-									for (int k = -radius; k <= radius; k++) {
-										if (i*i + j * j + k * k > cutoff_squared) {
-											continue;
-										}
-										if (!lattice.checkMoveValidity(coords, i, j, k)) {
-											continue;
-										}
-										lattice.calculateDestinationCoords(coords, i, j, k, coords_dest);
-										consider_smoothing[lattice.getSiteIndex(coords_dest)] = true;
+		// The neighborhood of each site consists of the offsets within the cutoff radius, not including the site itself.
+		// Index deltas are stored alongside the offsets so that sites away from the lattice edges can be evaluated without any boundary checks.
+		vector<Coords> offsets;
+		vector<long> index_deltas;
+		Coords coords_offset;
+		for (int i = -radius; i <= radius; i++) {
+			for (int j = -radius; j <= radius; j++) {
+				for (int k = -radius; k <= radius; k++) {
+					if ((i == 0 && j == 0 && k == 0) || (i*i + j * j + k * k) > cutoff_squared) {
+						continue;
+					}
+					coords_offset.setXYZ(i, j, k);
+					offsets.push_back(coords_offset);
+					index_deltas.push_back(i*plane_size + (long)j*height + k);
+				}
+			}
+		}
+		// Smoothing operates on a local copy of the site types, and the lattice is updated once the process is finished.
+		vector<char> site_types(num_sites);
+		// When the lattice only contains type 1 and type 2 sites, the number of sites of each type in the neighborhood of each site is kept up to date as sites swap types,
+		// so the roughness factor of each site is found without visiting its neighborhood.
+		bool use_type_counts = offsets.size() <= numeric_limits<unsigned short>::max();
+		for (long n = 0; n < num_sites; n++) {
+			site_types[n] = lattice.getSiteType(n);
+			if (site_types[n] != (char)1 && site_types[n] != (char)2) {
+				use_type_counts = false;
+			}
+		}
+		vector<unsigned short> type1_counts;
+		vector<unsigned short> type2_counts;
+		if (use_type_counts) {
+			calculateNeighborTypeCounts(site_types, radius, cutoff_squared, type1_counts, type2_counts);
+		}
+		// Calculates the index of the neighbor site at the given offset, returning -1 when the neighbor lies beyond a non-periodic boundary.
+		auto get_neighbor_index = [&](const int x, const int y, const int z, const Coords& offset) {
+			int x_dest = x + offset.x;
+			int y_dest = y + offset.y;
+			int z_dest = z + offset.z;
+			if (x_dest < 0 || x_dest >= length) {
+				if (!periodic_x) {
+					return (long)-1;
+				}
+				x_dest += (x_dest < 0) ? length : -length;
+			}
+			if (y_dest < 0 || y_dest >= width) {
+				if (!periodic_y) {
+					return (long)-1;
+				}
+				y_dest += (y_dest < 0) ? width : -width;
+			}
+			if (z_dest < 0 || z_dest >= height) {
+				if (!periodic_z) {
+					return (long)-1;
+				}
+				z_dest += (z_dest < 0) ? height : -height;
+			}
+			return x_dest*plane_size + (long)y_dest*height + z_dest;
+		};
+		auto is_interior = [&](const int x, const int y, const int z) {
+			return x >= radius && x < length - radius && y >= radius && y < width - radius && z >= radius && z < height - radius;
+		};
+		// Calculates the roughness factor of the target site, given by the fraction of nearby sites that are a different type,
+		// and swaps the site's type if the roughness factor is greater than the smoothing_threshold.
+		auto smooth_site = [&](const long site_index, const int x, const int y, const int z) {
+			const char site_type = site_types[site_index];
+			int site_count = 0;
+			int count_dissimilar = 0;
+			if (use_type_counts) {
+				count_dissimilar = (site_type == (char)1) ? type2_counts[site_index] : type1_counts[site_index];
+				site_count = type1_counts[site_index] + type2_counts[site_index];
+			}
+			else if (is_interior(x, y, z)) {
+				for (auto delta : index_deltas) {
+					if (site_types[site_index + delta] != site_type) {
+						count_dissimilar++;
+					}
+				}
+				site_count = (int)index_deltas.size();
+			}
+			else {
+				for (const auto& offset : offsets) {
+					long neighbor_index = get_neighbor_index(x, y, z, offset);
+					if (neighbor_index < 0) {
+						continue;
+					}
+					if (site_types[neighbor_index] != site_type) {
+						count_dissimilar++;
+					}
+					site_count++;
+				}
+			}
+			if ((double)count_dissimilar / (double)site_count > smoothing_threshold) {
+				if (site_type == (char)1) {
+					site_types[site_index] = (char)2;
+				}
+				else if (site_type == (char)2) {
+					site_types[site_index] = (char)1;
+				}
+				return true;
+			}
+			return false;
+		};
+		// When a site swaps types, all surrounding sites must be reconsidered for smoothing, and their neighbor type counts are updated.
+		auto update_neighbors = [&](const long site_index, const int x, const int y, const int z, vector<char>& consider_smoothing) {
+			bool interior = is_interior(x, y, z);
+			bool is_type1 = (site_types[site_index] == (char)1);
+			for (int m = 0; m < (int)offsets.size(); m++) {
+				long neighbor_index = interior ? site_index + index_deltas[m] : get_neighbor_index(x, y, z, offsets[m]);
+				if (neighbor_index < 0) {
+					continue;
+				}
+				consider_smoothing[neighbor_index] = 1;
+				if (use_type_counts) {
+					if (is_type1) {
+						type1_counts[neighbor_index]++;
+						type2_counts[neighbor_index]--;
+					}
+					else {
+						type1_counts[neighbor_index]--;
+						type2_counts[neighbor_index]++;
+					}
+				}
+			}
+		};
+		if (!enable_parallel) {
+			// The consider_smoothing vector keeps track of whether each site is near the interface and should be considered for smoothing.
+			// Sites in the interior of the domains or at very smooth interfaces do not need to be continually reconsidered for smoothing.
+			// Each sweep jumps directly between the marked sites in lattice order, so sites marked ahead of the current position are visited in the same sweep
+			// and the result is identical to that of sweeping over every site of the lattice.
+			vector<char> consider_smoothing(num_sites, 1);
+			int site_count = 1;
+			while (site_count > 0) {
+				site_count = 0;
+				auto it = consider_smoothing.begin();
+				while ((it = find(it, consider_smoothing.end(), (char)1)) != consider_smoothing.end()) {
+					long site_index = (long)(it - consider_smoothing.begin());
+					int x = (int)(site_index / plane_size);
+					int y = (int)((site_index % plane_size) / height);
+					int z = (int)(site_index % height);
+					if (smooth_site(site_index, x, y, z)) {
+						site_count++;
+						update_neighbors(site_index, x, y, z, consider_smoothing);
+					}
+					// Sites with a low roughness_factor are not swapped and are removed from reconsideration.
+					else {
+						*it = 0;
+					}
+					++it;
+				}
+			}
+		}
+		else {
+			// The lattice is divided into columns of blocks in the x-y plane that are assigned one of four colors in a checkerboard pattern.
+			// Each block is at least twice the smoothing radius wide, so blocks of the same color never read or update any of the same sites and can be processed concurrently.
+			// Periodic directions need an even number of blocks so that the first and last blocks are different colors.
+			auto get_block_count = [&](const int dim, const bool is_periodic) {
+				int block_size = 2 * radius;
+				int count = is_periodic ? 2 * (dim / (2 * block_size)) : dim / block_size;
+				return (count < 2) ? 1 : count;
+			};
+			const int blocks_x = get_block_count(length, periodic_x);
+			const int blocks_y = get_block_count(width, periodic_y);
+			auto get_block_start = [](const int block, const int block_count, const int dim) {
+				return (int)(((long)block*dim + block_count - 1) / block_count);
+			};
+			vector<vector<int>> color_blocks(4);
+			for (int bx = 0; bx < blocks_x; bx++) {
+				for (int by = 0; by < blocks_y; by++) {
+					color_blocks[2 * (bx % 2) + (by % 2)].push_back(bx*blocks_y + by);
+				}
+			}
+			// Each block jumps between its marked sites in lattice order in the same way as the serial process.
+			// Sites marked in neighboring blocks are visited when the color of that block is processed, so the result does not depend on the number of threads.
+			vector<char> consider_smoothing(num_sites, 1);
+			long site_count = 1;
+			while (site_count > 0) {
+				site_count = 0;
+				for (const auto& blocks : color_blocks) {
+#pragma omp parallel for schedule(dynamic) reduction(+:site_count)
+					for (int b = 0; b < (int)blocks.size(); b++) {
+						const int bx = blocks[b] / blocks_y;
+						const int by = blocks[b] % blocks_y;
+						for (int x = get_block_start(bx, blocks_x, length); x < get_block_start(bx + 1, blocks_x, length); x++) {
+							for (int y = get_block_start(by, blocks_y, width); y < get_block_start(by + 1, blocks_y, width); y++) {
+								auto column_begin = consider_smoothing.begin() + (x*plane_size + (long)y*height);
+								auto column_end = column_begin + height;
+								auto it = column_begin;
+								while ((it = find(it, column_end, (char)1)) != column_end) {
+									long site_index = (long)(it - consider_smoothing.begin());
+									int z = (int)(it - column_begin);
+									if (smooth_site(site_index, x, y, z)) {
+										site_count++;
+										update_neighbors(site_index, x, y, z, consider_smoothing);
+									}
+									else {
+										*it = 0;
 									}
+									++it;
 								}
 							}
 						}
-						// Sites with a low roughness_factor are not swapped and are removed from reconsideration.
-						else {
-							consider_smoothing[lattice.getSiteIndex(x, y, z)] = false;
-						}
 					}
 				}
 			}
 		}
+		for (long n = 0; n < num_sites; n++) {
+			if (site_types[n] != lattice.getSiteType(n)) {
+				lattice.setSiteType(n, site_types[n]);
+			}
+		}
 		// The smoothing process can change the mix fraction, so the final mix fraction is recalculated and the Mix_fraction property is updated.
 		calculateMixFractions();
 	}
 
+	vector<pair<double, int>> Morphology::getChordLengthHistogram(const char site_type, const int direction) const {
+		if (direction < 1 || direction > 3) {
+			cout << ID << ": Error! The input direction must be 1, 2, or 3, but " << direction << " was entered." << endl;
+			throw invalid_argument("Error! The input direction must be 1, 2, or 3.");
+		}
+		return ChordLengthHistogram_data[getSiteTypeIndex(site_type)][direction - 1];
+	}
+
+	double Morphology::getConnectedVolumeFraction(const char site_type) const {
+		if (site_type != (char)1 && site_type != (char)2) {
+			cout << ID << ": Error! The connected volume fraction can only be determined for site types 1 and 2." << endl;
+			throw invalid_argument("Error! The connected volume fraction can only be determined for site types 1 and 2.");
+		}
+		int n = getSiteTypeIndex(site_type);
+		if (Connected_volumes[n] < 0) {
+			return -1;
+		}
+		long int type_volume = accumulate(Domain_volumes[n].begin(), Domain_volumes[n].end(), 0L);
+		return (type_volume > 0) ? (double)Connected_volumes[n] / (double)type_volume : 0.0;
+	}
+
 	vector<double> Morphology::getCorrelationData(const char site_type) const {
 		if (Correlation_data[getSiteTypeIndex(site_type)][0] == 0) {
 			cout << ID << ": Error getting correlation data: Correlation data has not been calculated." << endl;
@@ -1759,6 +2942,34 @@ namespace Ising_OPV {
 		return Domain_sizes[getSiteTypeIndex(site_type)];
 	}
 
+	double Morphology::getDomainSizeError(char site_type) const {
+		return Domain_size_errors[getSiteTypeIndex(site_type)];
+	}
+
+	vector<pair<double, int>> Morphology::getDomainVolumeHistogram(const char site_type) const {
+		// The bins cover volumes from 1 site up to the size of the lattice.
+		int N_bins = 1;
+		while (N_bins < 62 && (1L << N_bins) <= lattice.getNumSites()) {
+			N_bins++;
+		}
+		vector<pair<double, int>> hist(N_bins);
+		for (int i = 0; i < N_bins; i++) {
+			hist[i] = make_pair((double)i, 0);
+		}
+		for (const auto volume : Domain_volumes[getSiteTypeIndex(site_type)]) {
+			int bin = 0;
+			while ((2L << bin) <= volume) {
+				bin++;
+			}
+			hist[bin].second++;
+		}
+		return hist;
+	}
+
+	vector<long int> Morphology::getDomainVolumes(const char site_type) const {
+		return Domain_volumes[getSiteTypeIndex(site_type)];
+	}
+
 	int Morphology::getHeight() const {
 		return lattice.getHeight();
 	}
@@ -1779,44 +2990,84 @@ namespace Ising_OPV {
 		return lattice.getLength();
 	}
 
+	double Morphology::getMeanChordLength(const char site_type, const int direction) const {
+		if (direction < 1 || direction > 3) {
+			cout << ID << ": Error! The input direction must be 1, 2, or 3, but " << direction << " was entered." << endl;
+			throw invalid_argument("Error! The input direction must be 1, 2, or 3.");
+		}
+		return Mean_chord_lengths[getSiteTypeIndex(site_type)][direction - 1];
+	}
+
 	double Morphology::getMixFraction(const char site_type) const {
 		return Mix_fractions[getSiteTypeIndex(site_type)];
 	}
 
-	void Morphology::getSiteSampling(vector<long int>& site_indices, const char site_type, const int N_sites_max) {
-		vector<long int> all_sites(Site_type_counts[getSiteTypeIndex(site_type)], 0);
-		int m = 0;
-		for (long n = 0; n < lattice.getNumSites(); n++) {
-			if (lattice.getSiteType(n) == site_type && m < (int)all_sites.size()) {
-				all_sites[m] = n;
-				m++;
-			}
+	double Morphology::getPercolatingVolumeFraction(const char site_type) const {
+		int n = getSiteTypeIndex(site_type);
+		if (Percolating_volumes[n] < 0) {
+			return -1;
 		}
-		shuffle(all_sites.begin(), all_sites.end(), gen);
-		if (N_sites_max > (int)all_sites.size()) {
-			site_indices.assign(all_sites.begin(), all_sites.end());
+		long int type_volume = accumulate(Domain_volumes[n].begin(), Domain_volumes[n].end(), 0L);
+		return (type_volume > 0) ? (double)Percolating_volumes[n] / (double)type_volume : 0.0;
+	}
+
+	unsigned int Morphology::getBrightnessKey(const float brightness) const {
+		// Negative zero is given the same key as positive zero
+		const float value = (brightness == 0.0f) ? 0.0f : brightness;
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		// Flipping all bits of negative values and only the sign bit of positive values makes the unsigned key order match the floating point order
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+
+	const vector<int>& Morphology::getInterfacialDistanceField() const {
+		if (Interfacial_distances_sq.empty() || Interfacial_distances_modification_count != lattice.getModificationCount()) {
+			calculateInterfacialDistanceField(Interfacial_distances_sq);
+			Interfacial_distances_modification_count = lattice.getModificationCount();
 		}
-		else {
-			site_indices.assign(all_sites.begin(), all_sites.begin() + N_sites_max);
+		return Interfacial_distances_sq;
+	}
+
+	char Morphology::getMixedSiteType(long int& N_mixed_remaining, long int& N_type1_remaining) {
+		uniform_int_distribution<long int> dist(0, N_mixed_remaining - 1);
+		bool is_type1 = (dist(gen) < N_type1_remaining);
+		N_mixed_remaining--;
+		if (is_type1) {
+			N_type1_remaining--;
+			return (char)1;
+		}
+		return (char)2;
+	}
+
+	void Morphology::getRandomSites(vector<long int>& site_indices, const char site_type, const int N_sites, unordered_set<long int>& selected_sites) {
+		uniform_int_distribution<long int> dist(0, lattice.getNumSites() - 1);
+		site_indices.clear();
+		site_indices.reserve(N_sites);
+		while ((int)site_indices.size() < N_sites) {
+			long int site_index = dist(gen);
+			if (lattice.getSiteType(site_index) == site_type && selected_sites.insert(site_index).second) {
+				site_indices.push_back(site_index);
+			}
 		}
 	}
 
-	void Morphology::getSiteSamplingZ(vector<long int>& site_indices, const char site_type, const int N_sites_max, const int z) {
-		vector<long int> all_sites;
+	void Morphology::getSiteSampling(vector<long int>& site_indices, const char site_type, const int N_sites_max) {
+		SiteReservoir reservoir;
+		initializeReservoir(reservoir, min((long int)N_sites_max, (long int)Site_type_counts[getSiteTypeIndex(site_type)]));
+		// Stream through the lattice in site index order
+		long int n = 0;
 		for (int x = 0; x < lattice.getLength(); x++) {
 			for (int y = 0; y < lattice.getWidth(); y++) {
-				if (lattice.getSiteType(x, y, z) == site_type) {
-					all_sites.push_back(lattice.getSiteIndex(x, y, z));
+				for (int z = 0; z < lattice.getHeight(); z++) {
+					if (lattice.getSiteType(x, y, z) == site_type) {
+						addReservoirSite(reservoir, n);
+					}
+					n++;
 				}
 			}
 		}
-		shuffle(all_sites.begin(), all_sites.end(), gen);
-		if (N_sites_max > (int)all_sites.size()) {
-			site_indices.assign(all_sites.begin(), all_sites.end());
-		}
-		else {
-			site_indices.assign(all_sites.begin(), all_sites.begin() + N_sites_max);
-		}
+		shuffle(reservoir.site_indices.begin(), reservoir.site_indices.end(), gen);
+		site_indices.swap(reservoir.site_indices);
 	}
 
 	int Morphology::getSiteTypeIndex(const char site_type) const {
@@ -1849,212 +3100,67 @@ namespace Ising_OPV {
 
 	vector<Morphology> Morphology::importTomogramMorphologyFile() {
 		vector<Morphology> morphologies;
+		importTomogramMorphologyFile([&morphologies](Morphology& morph) {
+			morphologies.push_back(move(morph));
+		});
+		return morphologies;
+	}
+
+	void Morphology::importTomogramMorphologyFile(const function<void(Morphology&)>& output_function) {
 		if (!Params.Enable_import_tomogram) {
 			cout << ID << ": Error! Attempting to import tomogram data when tomogram import is not enabled in the parameters." << endl;
 			throw runtime_error("Error! Attempting to import tomogram data when tomogram import is not enabled in the parameters.");
 		}
-		string metadata_filename = Params.Tomogram_name + ".xml";
-		string data_filename = Params.Tomogram_name + ".raw";
-		// Parse XML metadata file
-		cout << ID << ": Loading and Parsing the XML metadata file..." << endl;
-		XMLDocument xml_doc;
-		string data_format;
-		FILE* xml_file_ptr;
-		xml_file_ptr = fopen(metadata_filename.c_str(), "rb");
-		if (xml_file_ptr == NULL) {
-			cout << ID << ": Error! XML metadata file not found." << endl;
-			throw runtime_error("Error! XML metadata file not found.");
-		}
-		xml_doc.LoadFile(xml_file_ptr);
-		if (xml_doc.Error()) {
-			xml_doc.PrintError();
-			cout << ID << ": Error loading XML metadata file." << endl;
-			throw runtime_error("Error loading XML metadata file.");
-		}
-		// Analyze XML info file based on metadata format version
-		Version required_version("1.0.0");
-		string schema_version_str = xml_doc.FirstChildElement("tomogram_metadata")->Attribute("schema_version");
-		Version schema_version(schema_version_str);
-		// Initialize lattice params based on xml data
-		Lattice::Lattice_Params lattice_params;
-		if (schema_version == required_version) {
-			lattice_params.Length = atoi(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("length")->GetText());
-			lattice_params.Width = atoi(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("width")->GetText());
-			lattice_params.Height = atoi(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("height")->GetText());
-			lattice_params.Unit_size = atof(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("pixel_size")->FirstChildElement("value")->GetText());
-			// Save additional xml data needed
-			data_format = xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("data_format")->GetText();
-			if (data_format.compare("8 bit") != 0 && data_format.compare("16 bit") != 0) {
-				cout << "Error! The xml metadata file does not specify a valid data format. Only 8 bit and 16 bit formats are supported." << endl;
-				throw runtime_error("Error! The xml metadata file does not specify a valid data format. Only 8 bit and 16 bit formats are supported.");
-			}
-			// Initialize Morphology site types
-			int site_type_index = 0;
-			XMLElement* element_ptr = xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("sample_info")->FirstChildElement("composition_info")->FirstChildElement("chemical_component");
-			while (element_ptr != 0) {
-				addSiteType((char)(site_type_index + 1));
-				Mix_fractions[site_type_index] = atof(element_ptr->FirstChildElement("vol_frac")->GetText());
-				element_ptr = element_ptr->NextSiblingElement("chemical_component");
-				site_type_index++;
-			}
-		}
-		else {
-			cout << ID << ": Error! XML metadata schema version not supported. Only v1.0.0 is supported." << endl;
-			throw runtime_error("Error! XML metadata schema version not supported. Only v1.0.0 is supported.");
-		}
-		fclose(xml_file_ptr);
-		double Mix_fraction_import = Mix_fractions[0];
-		// Construct initial lattice based on XML metadata
-		Lattice lattice_i;
-		lattice_i.init(lattice_params);
-		// Open and read data file
-		cout << ID << ": Loading RAW data file..." << endl;
-		ifstream data_file(data_filename, ifstream::in | ifstream::binary);
-		if (!data_file.is_open()) {
-			cout << ID << ": Error! Tomogram binary RAW file " << data_filename << " could not be opened." << endl;
-			throw runtime_error("Error! Tomogram binary RAW file could not be opened.");
-		}
-		data_file.seekg(0, data_file.end);
-		int N_bytes = (int)data_file.tellg();
-		data_file.seekg(0, data_file.beg);
-		vector<float> data_vec;
-		if (data_format.compare("8 bit") == 0) {
-			unsigned char* data_block = new unsigned char[N_bytes];
-			data_file.read((char*)data_block, N_bytes);
-			data_vec.resize(N_bytes);
-			for (int i = 0; i < (int)data_vec.size(); i++) {
-				data_vec[i] = (float)data_block[i];
-			}
-			delete[] data_block;
-		}
-		else if (data_format.compare("16 bit") == 0) {
-			char16_t* data_block = new char16_t[N_bytes / 2];
-			data_file.read((char*)data_block, N_bytes);
-			data_vec.resize(N_bytes / 2);
-			for (int i = 0; i < (int)data_vec.size(); i++) {
-				data_vec[i] = (float)data_block[i];
+		// The tomogram data is only loaded, interpolated, and analyzed on the first call, and later calls only create a new random assignment of the mixed phase sites
+		if (!Tomogram_data) {
+			shared_ptr<TomogramData> tomogram_data(new TomogramData);
+			loadTomogramData(*tomogram_data);
+			Tomogram_data = tomogram_data;
+		}
+		const TomogramData& tomogram_data = *Tomogram_data;
+		double Mix_fraction_import = tomogram_data.mix_fraction;
+		// Determine the dimensions of the extracted segments, which are the whole lattice when only one segment is extracted
+		int dim = 1;
+		int segment_length = tomogram_data.lattice_params.Length;
+		int segment_width = tomogram_data.lattice_params.Width;
+		int offset_x = 0;
+		int offset_y = 0;
+		if (Params.N_extracted_segments > 1) {
+			dim = round_int(sqrt(Params.N_extracted_segments));
+			int new_length = tomogram_data.lattice_params.Length / dim;
+			// make dimensions even
+			if (new_length % 2 != 0) {
+				new_length--;
 			}
-			delete[] data_block;
-		}
-		data_file.close();
-		// Check amount of data read from the RAW file
-		if ((int)data_vec.size() != lattice_i.getNumSites()) {
-			cout << "Error! The imported tomogram RAW file does not contain the correct number of sites." << endl;
-			cout << "The initial lattice has " << lattice_i.getNumSites() << " sites but the data file has " << data_vec.size() << " entries." << endl;
-			throw runtime_error("Error! The imported tomogram RAW file does not contain the correct number of sites.");
-		}
-		// Rotate image data to standard Ising_OPV reference frame
-		int index = 0;
-		vector<float> data_vec_new(data_vec.size());
-		for (int k = 0; k < lattice_i.getHeight(); k++) {
-			for (int j = 0; j < lattice_i.getWidth(); j++) {
-				for (int i = 0; i < lattice_i.getLength(); i++) {
-					data_vec_new[lattice_i.getSiteIndex(i, j, k)] = data_vec[index];
-					index++;
-				}
+			int new_width = tomogram_data.lattice_params.Width / dim;
+			if (new_width % 2 != 0) {
+				new_width--;
 			}
-		}
-		vector<float>().swap(data_vec);
-		// Construct lattice with desired unit size
-		cout << ID << ": Interpolating data to construct final lattice..." << endl;
-		// Determine final lattice dimensions based on desired unit size
-		lattice_params.Length = (int)floor(lattice_params.Length*(lattice_params.Unit_size / Params.Desired_unit_size));
-		lattice_params.Width = (int)floor(lattice_params.Width*(lattice_params.Unit_size / Params.Desired_unit_size));
-		lattice_params.Height = (int)floor(lattice_params.Height*(lattice_params.Unit_size / Params.Desired_unit_size));
-		lattice_params.Unit_size = Params.Desired_unit_size;
-		lattice.init(lattice_params);
-		vector<float> data_vec_final(lattice.getNumSites());
-		for (int i = 0; i < lattice.getLength(); i++) {
-			for (int j = 0; j < lattice.getWidth(); j++) {
-				for (int k = 0; k < lattice.getHeight(); k++) {
-					double x = i * lattice.getUnitSize();
-					double y = j * lattice.getUnitSize();
-					double z = k * lattice.getUnitSize();
-					static vector<float> weights(8, 0.0);
-					static vector<float> vals(8, 0.0);
-					int x1 = (int)floor(x / lattice_i.getUnitSize());
-					int x2 = (int)ceil(x / lattice_i.getUnitSize());
-					int y1 = (int)floor(y / lattice_i.getUnitSize());
-					int y2 = (int)ceil(y / lattice_i.getUnitSize());
-					int z1 = (int)floor(z / lattice_i.getUnitSize());
-					int z2 = (int)ceil(z / lattice_i.getUnitSize());
-					if ((x - x1 * lattice_i.getUnitSize()) < 1e-6 && (y - y1 * lattice_i.getUnitSize()) < 1e-6 && (z - z1 * lattice_i.getUnitSize()) < 1e-6) {
-						data_vec_final[lattice.getSiteIndex(i, j, k)] = data_vec_new[lattice_i.getSiteIndex(x1, y1, z1)];
-						continue;
-					}
-					if (x2 >= lattice_i.getLength()) {
-						x2 = lattice_i.getLength() - 1;
-					}
-					if (y2 >= lattice_i.getWidth()) {
-						y2 = lattice_i.getWidth() - 1;
-					}
-					if (z2 >= lattice_i.getHeight()) {
-						z2 = lattice_i.getHeight() - 1;
-					}
-					vals[0] = data_vec_new[lattice_i.getSiteIndex(x1, y1, z1)];
-					vals[1] = data_vec_new[lattice_i.getSiteIndex(x1, y2, z1)];
-					vals[2] = data_vec_new[lattice_i.getSiteIndex(x2, y1, z1)];
-					vals[3] = data_vec_new[lattice_i.getSiteIndex(x2, y2, z1)];
-					vals[4] = data_vec_new[lattice_i.getSiteIndex(x1, y1, z2)];
-					vals[5] = data_vec_new[lattice_i.getSiteIndex(x1, y2, z2)];
-					vals[6] = data_vec_new[lattice_i.getSiteIndex(x2, y1, z2)];
-					vals[7] = data_vec_new[lattice_i.getSiteIndex(x2, y2, z2)];
-					weights[0] = (float)(1.0 / (intpow(x - x1 * lattice_i.getUnitSize(), 2) + intpow(y - y1 * lattice_i.getUnitSize(), 2) + intpow(z - z1 * lattice_i.getUnitSize(), 2)));
-					weights[1] = (float)(1.0 / (intpow(x - x1 * lattice_i.getUnitSize(), 2) + intpow(y - y2 * lattice_i.getUnitSize(), 2) + intpow(z - z1 * lattice_i.getUnitSize(), 2)));
-					weights[2] = (float)(1.0 / (intpow(x - x2 * lattice_i.getUnitSize(), 2) + intpow(y - y1 * lattice_i.getUnitSize(), 2) + intpow(z - z1 * lattice_i.getUnitSize(), 2)));
-					weights[3] = (float)(1.0 / (intpow(x - x2 * lattice_i.getUnitSize(), 2) + intpow(y - y2 * lattice_i.getUnitSize(), 2) + intpow(z - z1 * lattice_i.getUnitSize(), 2)));
-					weights[4] = (float)(1.0 / (intpow(x - x1 * lattice_i.getUnitSize(), 2) + intpow(y - y1 * lattice_i.getUnitSize(), 2) + intpow(z - z2 * lattice_i.getUnitSize(), 2)));
-					weights[5] = (float)(1.0 / (intpow(x - x1 * lattice_i.getUnitSize(), 2) + intpow(y - y2 * lattice_i.getUnitSize(), 2) + intpow(z - z2 * lattice_i.getUnitSize(), 2)));
-					weights[6] = (float)(1.0 / (intpow(x - x2 * lattice_i.getUnitSize(), 2) + intpow(y - y1 * lattice_i.getUnitSize(), 2) + intpow(z - z2 * lattice_i.getUnitSize(), 2)));
-					weights[7] = (float)(1.0 / (intpow(x - x2 * lattice_i.getUnitSize(), 2) + intpow(y - y2 * lattice_i.getUnitSize(), 2) + intpow(z - z2 * lattice_i.getUnitSize(), 2)));
-					std::transform(vals.begin(), vals.end(), weights.begin(), vals.begin(), multiplies<float>());
-					data_vec_final[lattice.getSiteIndex(i, j, k)] = accumulate(vals.begin(), vals.end(), 0.0f) / accumulate(weights.begin(), weights.end(), 0.0f);
-				}
-			}
-		}
-		vector<float>().swap(data_vec_new);
-		// Use pixel brightness cutoff method to assign site types, dark sites are type2 and bright sites are type1
-		cout << ID << ": Analyzing pixel brightness to assign site types..." << endl;
-		// Determine number of each type of site
-		int N_type1_total = round_int(Mix_fraction_import * lattice.getNumSites());
-		int N_type2_total = lattice.getNumSites() - N_type1_total;
-		int N_mixed_total = round_int(Params.Mixed_frac * lattice.getNumSites());
-		int N_type1_mixed = round_int(Params.Mixed_conc * N_mixed_total);
-		int N_type2_mixed = N_mixed_total - N_type1_mixed;
-		int N_type1_pure = N_type1_total - N_type1_mixed;
-		int N_type2_pure = N_type2_total - N_type2_mixed;
-		// Create vector of indices sorted by the corresponding pixel brightness
-		vector<int> indices(data_vec_final.size());
-		iota(indices.begin(), indices.end(), 0);
-		sort(indices.begin(), indices.end(), [&data_vec_final](const int& a, const int& b) {
-			return (data_vec_final[a] < data_vec_final[b]);
-		});
-		// Assign indices to a site type from pure regions
-		vector<int> type1_indices;
-		type1_indices.insert(type1_indices.end(), indices.end() - N_type1_pure, indices.end());
-		vector<int> type2_indices;
-		type2_indices.insert(type2_indices.end(), indices.begin(), indices.begin() + N_type2_pure);
-		// Add the remaining indices to a vector of mixed indices
-		vector<int> mixed_indices;
-		mixed_indices.insert(mixed_indices.end(), indices.begin() + N_type2_pure, indices.end() - N_type1_pure);
-		// Shuffle the mixed indices
-		shuffle(mixed_indices.begin(), mixed_indices.end(), gen);
-		// Assign mixed indices as type1 or type2 
-		type1_indices.insert(type1_indices.end(), mixed_indices.begin(), mixed_indices.begin() + N_type1_mixed);
-		type2_indices.insert(type2_indices.end(), mixed_indices.begin() + N_type1_mixed, mixed_indices.end());
-		// Clear existing Site_type_counts data
+			int size = (new_length < new_width) ? new_length : new_width;
+			segment_length = size;
+			segment_width = size;
+			offset_x = (tomogram_data.lattice_params.Length - size * dim) / 2;
+			offset_y = (tomogram_data.lattice_params.Width - size * dim) / 2;
+		}
+		if (Params.Enable_tiled_tomogram_import) {
+			importTomogramSegments_Tiled(dim, segment_length, segment_width, offset_x, offset_y, output_function);
+			return;
+		}
+		if (lattice.getLength() != tomogram_data.lattice_params.Length || lattice.getWidth() != tomogram_data.lattice_params.Width || lattice.getHeight() != tomogram_data.lattice_params.Height) {
+			lattice.init(tomogram_data.lattice_params);
+		}
+		vector<char> site_types = tomogram_data.site_types;
+		// Randomly assign the mixed phase sites as type1 or type2 in classification order
+		long int N_mixed_remaining = (long int)tomogram_data.mixed_indices.size();
+		long int N_type1_remaining = tomogram_data.N_type1_mixed;
+		for (const auto site_index : tomogram_data.mixed_indices) {
+			site_types[site_index] = getMixedSiteType(N_mixed_remaining, N_type1_remaining);
+		}
+		// Count the sites of each type and assign them to the lattice
 		for (int n = 0; n < (int)Site_types.size(); n++) {
-			Site_type_counts[n] = 0;
-		}
-		// Assign sites based on indices vectors
-		for (auto& item : type1_indices) {
-			lattice.setSiteType(item, (char)1);
-			Site_type_counts[getSiteTypeIndex((char)1)]++;
-		}
-		for (auto& item : type2_indices) {
-			lattice.setSiteType(item, (char)2);
-			Site_type_counts[getSiteTypeIndex((char)2)]++;
+			Site_type_counts[n] = (int)count(site_types.begin(), site_types.end(), Site_types[n]);
 		}
+		lattice.setSiteTypes(site_types);
 		// Check that all sites were assigned a type
 		if (lattice.getNumSites() != accumulate(Site_type_counts.begin(), Site_type_counts.end(), 0)) {
 			cout << ID << ": Error importing morphology file. All sites were not assigned to a valid site type." << endl;
@@ -2068,38 +3174,262 @@ namespace Ising_OPV {
 		}
 		// Generate morphology set
 		cout << ID << ": Creating morphology set from tomogram data." << endl;
-		if (Params.N_extracted_segments > 1) {
-			int dim = round_int(sqrt(Params.N_extracted_segments));
-			int new_length = lattice.getLength() / dim;
-			// make dimensions even
-			if (new_length % 2 != 0) {
-				new_length--;
-			}
-			int new_width = lattice.getWidth() / dim;
-			if (new_width % 2 != 0) {
-				new_width--;
-			}
-			int size = (new_length < new_width) ? new_length : new_width;
-			int offset_x = (lattice.getLength() - size * dim) / 2;
-			int offset_y = (lattice.getWidth() - size * dim) / 2;
+		if (dim > 1) {
 			Lattice sublattice;
 			Parameters params_new = Params;
-			params_new.Length = size;
-			params_new.Width = size;
+			params_new.Length = segment_length;
+			params_new.Width = segment_width;
 			params_new.Height = lattice.getHeight();
 			params_new.Enable_periodic_z = false;
 			for (int x = 0; x < dim; x++) {
 				for (int y = 0; y < dim; y++) {
-					sublattice = lattice.extractSublattice(x*size + offset_x, size, y*size + offset_y, size, 0, lattice.getHeight());
-					morphologies.push_back(Morphology(sublattice, params_new, x * dim + y));
-					morphologies[x * dim + y].calculateMixFractions();
+					sublattice = lattice.extractSublattice(x*segment_length + offset_x, segment_length, y*segment_width + offset_y, segment_width, 0, lattice.getHeight());
+					Morphology morph(sublattice, params_new, x * dim + y);
+					morph.calculateMixFractions();
+					output_function(morph);
 				}
 			}
 		}
-		else {
-			morphologies.push_back(*this);
+		else {
+			Morphology morph(*this);
+			morph.Tomogram_data.reset();
+			output_function(morph);
+		}
+	}
+
+	void Morphology::importTomogramSegments_Tiled(const int dim, const int segment_length, const int segment_width, const int offset_x, const int offset_y, const function<void(Morphology&)>& output_function) {
+		const TomogramData& tomogram_data = *Tomogram_data;
+		const int height = tomogram_data.lattice_params.Height;
+		const int N_segments = dim * dim;
+		const size_t plane_size = (size_t)segment_length*segment_width;
+		const size_t segment_size = plane_size * height;
+		MappedFile data_file;
+		if (!data_file.open(Params.Tomogram_name + ".raw")) {
+			cout << ID << ": Error! Tomogram binary RAW file " << Params.Tomogram_name + ".raw" << " could not be opened." << endl;
+			throw runtime_error("Error! Tomogram binary RAW file could not be opened.");
+		}
+		ScratchFile scratch_file;
+		string filename = "tomogram_scratch_" + to_string(ID) + ".tmp";
+		if (!scratch_file.open(filename, segment_size*N_segments)) {
+			cout << ID << ": Error! Unable to create the tomogram scratch file." << endl;
+			throw runtime_error("Error! Unable to create the tomogram scratch file.");
+		}
+		char* segment_data = scratch_file.data();
+		// Classify the sites of each brick, randomly assigning the mixed phase sites in classification order, and write the sites that are within the segments to the scratch file
+		cout << ID << ": Assigning site types in z-bricks of " << tomogram_data.brick_height << " planes..." << endl;
+		vector<float> brick;
+		vector<long int> tie_counts(2, 0);
+		long int N_mixed_remaining = tomogram_data.N_mixed;
+		long int N_type1_remaining = tomogram_data.N_type1_mixed;
+		long int N_type1 = 0;
+		processTomogramBricks(tomogram_data, data_file, brick, [&](const int z_start, const int z_end) {
+			classifyTomogramBrick(tomogram_data, brick, z_start, z_end, tie_counts, [&](const int i, const int j, const int k, const char site_type) {
+				char type = (site_type == 0) ? getMixedSiteType(N_mixed_remaining, N_type1_remaining) : site_type;
+				if (type == (char)1) {
+					N_type1++;
+				}
+				int x = i - offset_x;
+				int y = j - offset_y;
+				if (x < 0 || y < 0 || x >= dim * segment_length || y >= dim * segment_width) {
+					return;
+				}
+				size_t segment_index = (size_t)(x / segment_length)*dim + y / segment_width;
+				segment_data[segment_index*segment_size + (size_t)k*plane_size + (size_t)(x % segment_length)*segment_width + y % segment_width] = type;
+			});
+			for (int n = 0; n < N_segments; n++) {
+				scratch_file.release(n*segment_size + (size_t)z_start*plane_size, (size_t)(z_end - z_start)*plane_size);
+			}
+		});
+		data_file.close();
+		// Check the final mix fraction
+		long int N_sites = (long int)tomogram_data.lattice_params.Length*tomogram_data.lattice_params.Width*height;
+		if (abs((double)N_type1 / (double)N_sites - tomogram_data.mix_fraction) > 0.01) {
+			cout << ID << ": Error importing morphology file. Final type1 mix fraction does not match the mix fraction designated in the xml metadata file." << endl;
+			throw runtime_error("Error importing morphology file. Final type1 mix fraction does not match the mix fraction designated in the xml metadata file.");
+		}
+		// Generate morphology set
+		cout << ID << ": Creating morphology set from tomogram data." << endl;
+		Lattice::Lattice_Params lattice_params = tomogram_data.lattice_params;
+		lattice_params.Length = segment_length;
+		lattice_params.Width = segment_width;
+		Parameters params_new = Params;
+		params_new.Length = segment_length;
+		params_new.Width = segment_width;
+		params_new.Height = height;
+		params_new.Enable_periodic_z = lattice_params.Enable_periodic_z;
+		vector<char> site_types(segment_size);
+		for (int n = 0; n < N_segments; n++) {
+			// Reorder the segment from the scratch file layout, where the z index changes slowest, into the lattice layout
+			const char* data = segment_data + n * segment_size;
+			for (int k = 0; k < height; k++) {
+				for (int x = 0; x < segment_length; x++) {
+					for (int y = 0; y < segment_width; y++) {
+						site_types[((size_t)x*segment_width + y)*height + k] = data[(size_t)k*plane_size + (size_t)x*segment_width + y];
+					}
+				}
+			}
+			scratch_file.release(n*segment_size, segment_size);
+			Lattice sublattice;
+			sublattice.init(lattice_params);
+			sublattice.setSiteTypes(site_types);
+			Morphology morph(sublattice, params_new, (dim > 1) ? n : ID);
+			morph.calculateMixFractions();
+			output_function(morph);
+		}
+	}
+
+	bool Morphology::importMorphologyBinaryFile(const string& filename) {
+		MappedFile infile;
+		if (!infile.open(filename)) {
+			cout << ID << ": Error importing binary morphology file. " << filename << " could not be opened." << endl;
+			return false;
+		}
+		// Check the file signature and read the format version, lattice dimensions, periodic boundary options, number of site types, and number of bits per site
+		int header[9];
+		const size_t signature_size = 8;
+		if (infile.size() < signature_size + sizeof(header) || memcmp(infile.data(), Binary_file_signature, signature_size) != 0) {
+			cout << ID << ": Error importing binary morphology file. " << filename << " is not an Ising_OPV binary morphology file." << endl;
+			return false;
+		}
+		memcpy(header, infile.data() + signature_size, sizeof(header));
+		if (header[0] != Binary_file_format_version) {
+			cout << ID << ": Error importing binary morphology file. Binary file format version " << header[0] << " is not supported." << endl;
+			return false;
+		}
+		Lattice::Lattice_Params lattice_params;
+		lattice_params.Length = header[1];
+		lattice_params.Width = header[2];
+		lattice_params.Height = header[3];
+		lattice_params.Enable_periodic_x = (header[4] != 0);
+		lattice_params.Enable_periodic_y = (header[5] != 0);
+		lattice_params.Enable_periodic_z = (header[6] != 0);
+		lattice_params.Unit_size = 1.0;
+		int num_types = header[7];
+		int bits_per_site = header[8];
+		if (lattice_params.Length <= 0 || lattice_params.Width <= 0 || lattice_params.Height <= 0 || num_types <= 0 || num_types > 255 || (bits_per_site != 1 && bits_per_site != 2 && bits_per_site != 8)) {
+			cout << ID << ": Error importing binary morphology file. The file header is invalid." << endl;
+			return false;
+		}
+		size_t N_sites = (size_t)lattice_params.Length*(size_t)lattice_params.Width*(size_t)lattice_params.Height;
+		int sites_per_byte = 8 / bits_per_site;
+		size_t types_offset = signature_size + sizeof(header);
+		size_t data_offset = types_offset + (size_t)num_types + 2 * (size_t)num_types * sizeof(double);
+		if (infile.size() != data_offset + (N_sites + sites_per_byte - 1) / sites_per_byte) {
+			cout << ID << ": Error importing binary morphology file. The file size does not match the size of the morphology data." << endl;
+			return false;
+		}
+		// Each site type value must be unique, so that each packed index maps to one site type
+		const char* type_values = infile.data() + types_offset;
+		array<bool, 256> type_found;
+		type_found.fill(false);
+		for (int n = 0; n < num_types; n++) {
+			if (type_found[(unsigned char)type_values[n]]) {
+				cout << ID << ": Error importing binary morphology file. The file header is invalid." << endl;
+				return false;
+			}
+			type_found[(unsigned char)type_values[n]] = true;
+		}
+		// Create the lattice and get the domain size of each site type, which is stored in the order of the site type values in the file
+		lattice.init(lattice_params);
+		vector<double> domain_sizes(num_types);
+		memcpy(domain_sizes.data(), type_values + num_types, num_types * sizeof(double));
+		for (int n = 0; n < num_types; n++) {
+			addSiteType(type_values[n]);
+			Domain_sizes[getSiteTypeIndex(type_values[n])] = domain_sizes[n];
+		}
+		// Unpack the site types directly from the mapped data, where each packed value is the site type index and the first site is stored in the lowest bits of each byte
+		const unsigned char* data = (const unsigned char*)infile.data() + data_offset;
+		const unsigned char mask = (unsigned char)((1 << bits_per_site) - 1);
+		vector<char> site_types(N_sites);
+		array<long int, 256> type_counts;
+		type_counts.fill(0);
+		for (size_t n = 0; n < N_sites; n += sites_per_byte) {
+			unsigned char byte = data[n / sites_per_byte];
+			for (size_t i = n; i < n + sites_per_byte && i < N_sites; i++) {
+				unsigned char value = byte & mask;
+				byte = (unsigned char)(byte >> bits_per_site);
+				type_counts[value]++;
+				site_types[i] = (value < num_types) ? type_values[value] : (char)0;
+			}
+		}
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Site_type_counts[n] = 0;
+		}
+		for (int n = 0; n < num_types; n++) {
+			Site_type_counts[getSiteTypeIndex(type_values[n])] = (int)type_counts[n];
+		}
+		// Check that all sites were assigned a valid type
+		if (lattice.getNumSites() != accumulate(Site_type_counts.begin(), Site_type_counts.end(), 0L)) {
+			cout << ID << ": Error importing binary morphology file. All sites were not assigned to a valid site type." << endl;
+			return false;
+		}
+		lattice.setSiteTypes(site_types);
+		// The mix fractions are calculated from the site type counts, so the lattice does not need to be scanned again
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Mix_fractions[n] = (double)Site_type_counts[n] / (double)lattice.getNumSites();
+		}
+		return true;
+	}
+
+	bool Morphology::importMorphologyBuffer(const vector<char>& buffer) {
+		// Read the lattice dimensions, periodic boundary options, and number of site types from the buffer header
+		int header[7];
+		if (buffer.size() < sizeof(header)) {
+			cout << ID << ": Error importing morphology buffer. The buffer is too small to contain the morphology data." << endl;
+			return false;
+		}
+		memcpy(header, buffer.data(), sizeof(header));
+		Lattice::Lattice_Params lattice_params;
+		lattice_params.Length = header[0];
+		lattice_params.Width = header[1];
+		lattice_params.Height = header[2];
+		lattice_params.Enable_periodic_x = (header[3] != 0);
+		lattice_params.Enable_periodic_y = (header[4] != 0);
+		lattice_params.Enable_periodic_z = (header[5] != 0);
+		lattice_params.Unit_size = 1.0;
+		int num_types = header[6];
+		if (lattice_params.Length <= 0 || lattice_params.Width <= 0 || lattice_params.Height <= 0 || num_types <= 0 || num_types > 255) {
+			cout << ID << ": Error importing morphology buffer. The buffer header is invalid." << endl;
+			return false;
+		}
+		size_t N_sites = (size_t)lattice_params.Length*(size_t)lattice_params.Width*(size_t)lattice_params.Height;
+		size_t data_offset = sizeof(header) + (size_t)num_types + 2 * (size_t)num_types * sizeof(double);
+		if (buffer.size() != data_offset + N_sites) {
+			cout << ID << ": Error importing morphology buffer. The buffer size does not match the size of the morphology data." << endl;
+			return false;
+		}
+		// Each site type value must be unique, so that the domain size of each site type can be assigned
+		const char* type_values = buffer.data() + sizeof(header);
+		array<bool, 256> type_found;
+		type_found.fill(false);
+		for (int n = 0; n < num_types; n++) {
+			if (type_found[(unsigned char)type_values[n]]) {
+				cout << ID << ": Error importing morphology buffer. The buffer header is invalid." << endl;
+				return false;
+			}
+			type_found[(unsigned char)type_values[n]] = true;
+		}
+		// Create the lattice and get the domain size of each site type, which is stored in the order of the site type values in the buffer
+		lattice.init(lattice_params);
+		vector<double> domain_sizes(num_types);
+		memcpy(domain_sizes.data(), type_values + num_types, num_types * sizeof(double));
+		for (int n = 0; n < num_types; n++) {
+			addSiteType(type_values[n]);
+			Domain_sizes[getSiteTypeIndex(type_values[n])] = domain_sizes[n];
 		}
-		return morphologies;
+		// Assign the site types
+		vector<char> site_types(buffer.begin() + data_offset, buffer.end());
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Site_type_counts[n] = (int)count(site_types.begin(), site_types.end(), Site_types[n]);
+		}
+		// Check that all sites were assigned a type
+		if (lattice.getNumSites() != accumulate(Site_type_counts.begin(), Site_type_counts.end(), 0L)) {
+			cout << ID << ": Error importing morphology buffer. All sites were not assigned to a valid site type." << endl;
+			return false;
+		}
+		lattice.setSiteTypes(site_types);
+		calculateMixFractions();
+		return true;
 	}
 
 	bool Morphology::importMorphologyFile(ifstream& infile) {
@@ -2113,15 +3443,15 @@ namespace Ising_OPV {
 			cout << ID << ": Error importing morphology file. Input filestream is not open or is not a good state." << endl;
 			return false;
 		}
-		// Load file lines into string vector
-		vector<string> file_data;
-		while (getline(infile, line)) {
-			file_data.push_back(line);
-		}
+		// The file is parsed line by line in a single pass through a large read buffer
+		TextFileReader reader(infile);
+		const char* line_begin;
+		const char* line_end;
 		// Analyze file header line
-		if (file_data[0].substr(0, 9).compare("Ising_OPV") == 0) {
+		if (reader.getLine(line_begin, line_end) && line_end - line_begin >= 9 && string(line_begin, 9).compare("Ising_OPV") == 0) {
 			// extract version string
-			string version_str = file_data[0];
+			line.assign(line_begin, line_end);
+			string version_str = line;
 			version_str.erase(0, version_str.find('v') + 1);
 			version_str = version_str.substr(0, version_str.find(' '));
 			Version file_version(version_str);
@@ -2131,81 +3461,115 @@ namespace Ising_OPV {
 				return false;
 			}
 			// Check if file is in compressed format or not
-			is_file_compressed = (file_data[0].find("uncompressed") == string::npos);
+			is_file_compressed = (line.find("uncompressed") == string::npos);
 		}
 		else {
 			cout << ID << ": Error importing morphology file. Incorrect file format. Only morphology files generated by Ising_OPV v4.0.0-beta.1 or greater are supported." << endl;
 			return false;
 		}
-		// Get lattice dimensions
-		lattice_params.Length = atoi(file_data[1].c_str());
-		lattice_params.Width = atoi(file_data[2].c_str());
-		lattice_params.Height = atoi(file_data[3].c_str());
-		// Get lattice periodicity options
-		lattice_params.Enable_periodic_x = (bool)atoi(file_data[4].c_str());
-		lattice_params.Enable_periodic_y = (bool)atoi(file_data[5].c_str());
-		lattice_params.Enable_periodic_z = (bool)atoi(file_data[6].c_str());
+		// Get lattice dimensions, lattice periodicity options, and number of site types
+		long int header_values[7];
+		for (int n = 0; n < 7; n++) {
+			if (!reader.getLine(line_begin, line_end) || !parseInteger(line_begin, line_end, header_values[n])) {
+				cout << ID << ": Error importing morphology file. The file header is incomplete or invalid." << endl;
+				return false;
+			}
+		}
+		lattice_params.Length = (int)header_values[0];
+		lattice_params.Width = (int)header_values[1];
+		lattice_params.Height = (int)header_values[2];
+		lattice_params.Enable_periodic_x = (header_values[3] != 0);
+		lattice_params.Enable_periodic_y = (header_values[4] != 0);
+		lattice_params.Enable_periodic_z = (header_values[5] != 0);
+		int num_types = (int)header_values[6];
+		if (lattice_params.Length <= 0 || lattice_params.Width <= 0 || lattice_params.Height <= 0 || num_types <= 0 || num_types > 255) {
+			cout << ID << ": Error importing morphology file. The file header is incomplete or invalid." << endl;
+			return false;
+		}
 		// Create the lattice
 		lattice.init(lattice_params);
-		// Get number of site types
-		int num_types = atoi(file_data[7].c_str());
 		for (int n = 0; n < num_types; n++) {
 			addSiteType((char)(n + 1));
 		}
-		// Get domain size for each site type
-		for (int n = 0; n < num_types; n++) {
-			Domain_sizes[n] = atof(file_data[8 + n].c_str());
-		}
-		// Get mix fraction for each site type
-		for (int n = 0; n < num_types; n++) {
-			Mix_fractions[n] = atof(file_data[8 + num_types + n].c_str());
-		}
-		// Clear existing Site_type_counts data
-		for (int n = 0; n < (int)Site_types.size(); n++) {
-			Site_type_counts[n] = 0;
+		// Get domain size and then mix fraction for each site type
+		for (int n = 0; n < 2 * num_types; n++) {
+			if (!reader.getLine(line_begin, line_end)) {
+				cout << ID << ": Error importing morphology file. The file header is incomplete or invalid." << endl;
+				return false;
+			}
+			line.assign(line_begin, line_end);
+			if (n < num_types) {
+				Domain_sizes[n] = atof(line.c_str());
+			}
+			else {
+				Mix_fractions[n - num_types] = atof(line.c_str());
+			}
 		}
+		// The site types are parsed into a buffer in site index order and the number of sites of each type is counted along the way
+		long int N_sites = lattice.getNumSites();
+		vector<char> site_types(N_sites, 0);
+		array<long int, 256> type_counts;
+		type_counts.fill(0);
 		if (!is_file_compressed) {
-			for (int i = 8 + 2 * num_types; i < (int)file_data.size(); i++) {
-				stringstream linestream(file_data[i]);
-				string item;
-				vector<int> values;
-				values.reserve(4);
-				while (getline(linestream, item, ',')) {
-					values.push_back(atoi(item.c_str()));
-				}
-				lattice.setSiteType(values[0], values[1], values[2], (char)values[3]);
-				Site_type_counts[getSiteTypeIndex((char)values[3])]++;
-			}
-			// Check that all sites were assigned a type
-			if (lattice.getNumSites() != accumulate(Site_type_counts.begin(), Site_type_counts.end(), 0)) {
-				cout << ID << ": Error importing morphology file. All sites were not assigned to a valid site type." << endl;
-				return false;
+			// Each line contains the x, y, and z coordinates and the type of one site
+			long int values[4];
+			while (reader.getLine(line_begin, line_end)) {
+				const char* pos = line_begin;
+				bool success = true;
+				for (int n = 0; n < 4 && success; n++) {
+					if (n > 0) {
+						success = (pos != line_end && *pos == ',');
+						pos++;
+					}
+					success = success && parseInteger(pos, line_end, values[n]);
+				}
+				if (!success || values[0] < 0 || values[0] >= lattice.getLength() || values[1] < 0 || values[1] >= lattice.getWidth() || values[2] < 0 || values[2] >= lattice.getHeight() || values[3] <= 0 || values[3] > 255) {
+					cout << ID << ": Error parsing input morphology file. Invalid site data line." << endl;
+					return false;
+				}
+				long int index = lattice.getSiteIndex((int)values[0], (int)values[1], (int)values[2]);
+				if (site_types[index] != 0) {
+					cout << ID << ": Error parsing input morphology file. Site " << values[0] << "," << values[1] << "," << values[2] << " is assigned more than once." << endl;
+					return false;
+				}
+				site_types[index] = (char)values[3];
+				type_counts[values[3]]++;
 			}
 		}
 		else {
-			int site_count = 0;
-			int line_count = 8 + 2 * num_types;
-			char type = 0;
-			for (int x = 0; x < lattice.getLength(); x++) {
-				for (int y = 0; y < lattice.getWidth(); y++) {
-					for (int z = 0; z < lattice.getHeight(); z++) {
-						if (site_count == 0) {
-							if (line_count == (int)file_data.size()) {
-								cout << ID << ": Error parsing input morphology file. End of file reached before expected." << endl;
-								return false;
-							}
-							type = (char)atoi(file_data[line_count].substr(0, 1).c_str());
-							site_count = atoi(file_data[line_count].substr(1).c_str());
-							line_count++;
-						}
-						lattice.setSiteType(x, y, z, type);
-						Site_type_counts[getSiteTypeIndex(type)]++;
-						site_count--;
-					}
+			// Each line contains a single digit site type followed by the number of consecutive sites with that type in site index order
+			long int site_count = 0;
+			while (site_count < N_sites) {
+				if (!reader.getLine(line_begin, line_end)) {
+					cout << ID << ": Error parsing input morphology file. End of file reached before expected." << endl;
+					return false;
 				}
+				const char* pos = line_begin + 1;
+				long int run_length;
+				if (line_begin == line_end || *line_begin < '1' || *line_begin > '9' || !parseInteger(pos, line_end, run_length) || run_length <= 0) {
+					cout << ID << ": Error parsing input morphology file. Invalid site data line." << endl;
+					return false;
+				}
+				char type = (char)(*line_begin - '0');
+				run_length = min(run_length, N_sites - site_count);
+				memset(site_types.data() + site_count, type, run_length);
+				type_counts[type] += run_length;
+				site_count += run_length;
 			}
 		}
-		calculateMixFractions();
+		for (int n = 0; n < num_types; n++) {
+			Site_type_counts[n] = (int)type_counts[Site_types[n]];
+		}
+		// Check that all sites were assigned a type
+		if (N_sites != accumulate(Site_type_counts.begin(), Site_type_counts.end(), 0L)) {
+			cout << ID << ": Error importing morphology file. All sites were not assigned to a valid site type." << endl;
+			return false;
+		}
+		lattice.setSiteTypes(site_types);
+		// The mix fractions are calculated from the site type counts, so the lattice does not need to be scanned again
+		for (int n = 0; n < num_types; n++) {
+			Mix_fractions[n] = (double)Site_type_counts[n] / (double)N_sites;
+		}
 		return true;
 	}
 
@@ -2319,30 +3683,414 @@ namespace Ising_OPV {
 		}
 	}
 
-	bool Morphology::isNearInterface(const Coords& coords, const double distance) const {
-		int range = (int)ceil(distance);
-		double distance_sq = distance * distance;
-		Coords coords_dest;
-		for (int i = -range; i <= range; i++) {
-			for (int j = -range; j <= range; j++) {
-				for (int k = -range; k <= range; k++) {
-					if (abs(i) + abs(j) + abs(k) > range) {
-						continue;
+	template<typename T>
+	void Morphology::interpolateTomogramData(const T* data, const Lattice::Lattice_Params& params_initial, const Lattice::Lattice_Params& params_final, const int interpolation_order, const int z_start, const int z_end, vector<float>& data_final) const {
+		const int length_i = params_initial.Length;
+		const int width_i = params_initial.Width;
+		const int height_i = params_initial.Height;
+		const double unit_size_i = params_initial.Unit_size;
+		const double unit_size = params_final.Unit_size;
+		const int length = params_final.Length;
+		const int width = params_final.Width;
+		const int height = params_final.Height;
+		const int brick_height = z_end - z_start;
+		// Gets the value of the voxel at (x,y,z) in the RAW file layout.
+		auto get_value = [&](const int x, const int y, const int z) {
+			return (float)data[((long int)z*width_i + y)*length_i + x];
+		};
+		data_final.resize((size_t)length*width*brick_height);
+		if (interpolation_order == 0) {
+			// Data structure that stores the two input sites on either side of an output position along one axis, their squared distances from the output position,
+			// and whether the output position is aligned with the first input site
+			struct AxisNeighbors {
+				int index1;
+				int index2;
+				double distance1_sq;
+				double distance2_sq;
+				bool is_aligned;
+			};
+			auto calculate_neighbors = [&](const int N_out, const int N_in) {
+				vector<AxisNeighbors> neighbors(N_out);
+				for (int n = 0; n < N_out; n++) {
+					double position = n * unit_size;
+					auto& item = neighbors[n];
+					item.index1 = (int)floor(position / unit_size_i);
+					item.index2 = (int)ceil(position / unit_size_i);
+					item.is_aligned = (position - item.index1 * unit_size_i) < 1e-6;
+					if (item.index2 >= N_in) {
+						item.index2 = N_in - 1;
+					}
+					item.distance1_sq = intpow(position - item.index1 * unit_size_i, 2);
+					item.distance2_sq = intpow(position - item.index2 * unit_size_i, 2);
+				}
+				return neighbors;
+			};
+			const vector<AxisNeighbors> x_neighbors = calculate_neighbors(length, length_i);
+			const vector<AxisNeighbors> y_neighbors = calculate_neighbors(width, width_i);
+			const vector<AxisNeighbors> z_neighbors = calculate_neighbors(height, height_i);
+			const int tile_size = 32;
+#pragma omp parallel for schedule(dynamic)
+			for (int i = 0; i < length; i++) {
+				float weights[8];
+				float vals[8];
+				const AxisNeighbors& nx = x_neighbors[i];
+				for (int j_start = 0; j_start < width; j_start += tile_size) {
+					for (int k_start = z_start; k_start < z_end; k_start += tile_size) {
+						for (int j = j_start; j < min(j_start + tile_size, width); j++) {
+							const AxisNeighbors& ny = y_neighbors[j];
+							for (int k = k_start; k < min(k_start + tile_size, z_end); k++) {
+								const AxisNeighbors& nz = z_neighbors[k];
+								long int site_index = ((long int)i*width + j)*brick_height + (k - z_start);
+								if (nx.is_aligned && ny.is_aligned && nz.is_aligned) {
+									data_final[site_index] = get_value(nx.index1, ny.index1, nz.index1);
+									continue;
+								}
+								vals[0] = get_value(nx.index1, ny.index1, nz.index1);
+								vals[1] = get_value(nx.index1, ny.index2, nz.index1);
+								vals[2] = get_value(nx.index2, ny.index1, nz.index1);
+								vals[3] = get_value(nx.index2, ny.index2, nz.index1);
+								vals[4] = get_value(nx.index1, ny.index1, nz.index2);
+								vals[5] = get_value(nx.index1, ny.index2, nz.index2);
+								vals[6] = get_value(nx.index2, ny.index1, nz.index2);
+								vals[7] = get_value(nx.index2, ny.index2, nz.index2);
+								weights[0] = (float)(1.0 / (nx.distance1_sq + ny.distance1_sq + nz.distance1_sq));
+								weights[1] = (float)(1.0 / (nx.distance1_sq + ny.distance2_sq + nz.distance1_sq));
+								weights[2] = (float)(1.0 / (nx.distance2_sq + ny.distance1_sq + nz.distance1_sq));
+								weights[3] = (float)(1.0 / (nx.distance2_sq + ny.distance2_sq + nz.distance1_sq));
+								weights[4] = (float)(1.0 / (nx.distance1_sq + ny.distance1_sq + nz.distance2_sq));
+								weights[5] = (float)(1.0 / (nx.distance1_sq + ny.distance2_sq + nz.distance2_sq));
+								weights[6] = (float)(1.0 / (nx.distance2_sq + ny.distance1_sq + nz.distance2_sq));
+								weights[7] = (float)(1.0 / (nx.distance2_sq + ny.distance2_sq + nz.distance2_sq));
+								std::transform(vals, vals + 8, weights, vals, multiplies<float>());
+								data_final[site_index] = accumulate(vals, vals + 8, 0.0f) / accumulate(weights, weights + 8, 0.0f);
+							}
+						}
+					}
+				}
+			}
+			return;
+		}
+		ResamplingTable x_table;
+		ResamplingTable y_table;
+		ResamplingTable z_table;
+		calculateResamplingTable(length, unit_size, length_i, unit_size_i, interpolation_order, x_table);
+		calculateResamplingTable(width, unit_size, width_i, unit_size_i, interpolation_order, y_table);
+		calculateResamplingTable(height, unit_size, height_i, unit_size_i, interpolation_order, z_table);
+		// Only the input z-planes used by the brick are interpolated along x and y
+		const int z_start_i = z_table.indices[(size_t)z_start*z_table.N_taps];
+		const int height_brick_i = z_table.indices[(size_t)z_end*z_table.N_taps - 1] + 1 - z_start_i;
+#pragma omp parallel
+		{
+			// Each thread stores its current x-slab after interpolating along x and then after interpolating along y
+			vector<float> slab_x((size_t)width_i*height_brick_i);
+			vector<float> slab_xy((size_t)width*height_brick_i);
+#pragma omp for schedule(static)
+			for (int i = 0; i < length; i++) {
+				// Interpolate each input x-line at the x position of the slab
+				const int* x_indices = &x_table.indices[(size_t)i*x_table.N_taps];
+				const double* x_weights = &x_table.weights[(size_t)i*x_table.N_taps];
+				for (int z = 0; z < height_brick_i; z++) {
+					for (int y = 0; y < width_i; y++) {
+						const T* line = data + ((size_t)(z + z_start_i)*width_i + y)*length_i;
+						double value = 0.0;
+						for (int tap = 0; tap < x_table.N_taps; tap++) {
+							value += x_weights[tap] * line[x_indices[tap]];
+						}
+						slab_x[(size_t)z*width_i + y] = (float)value;
+					}
+				}
+				// Interpolate along y, storing the slab with the z index changing fastest
+				for (int j = 0; j < width; j++) {
+					const int* y_indices = &y_table.indices[(size_t)j*y_table.N_taps];
+					const double* y_weights = &y_table.weights[(size_t)j*y_table.N_taps];
+					for (int z = 0; z < height_brick_i; z++) {
+						const float* row = &slab_x[(size_t)z*width_i];
+						double value = 0.0;
+						for (int tap = 0; tap < y_table.N_taps; tap++) {
+							value += y_weights[tap] * row[y_indices[tap]];
+						}
+						slab_xy[(size_t)j*height_brick_i + z] = (float)value;
+					}
+				}
+				// Interpolate along z into the brick
+				for (int j = 0; j < width; j++) {
+					const float* line = &slab_xy[(size_t)j*height_brick_i];
+					float* line_final = &data_final[((size_t)i*width + j)*brick_height];
+					for (int k = z_start; k < z_end; k++) {
+						const int* z_indices = &z_table.indices[(size_t)k*z_table.N_taps];
+						const double* z_weights = &z_table.weights[(size_t)k*z_table.N_taps];
+						double value = 0.0;
+						for (int tap = 0; tap < z_table.N_taps; tap++) {
+							value += z_weights[tap] * line[z_indices[tap] - z_start_i];
+						}
+						line_final[k - z_start] = (float)value;
 					}
-					else if ((double)(i*i + j * j + k * k) > distance_sq) {
+				}
+			}
+		}
+	}
+
+	void Morphology::initializeReservoir(SiteReservoir& reservoir, const long int N_max) {
+		reservoir.site_indices.clear();
+		reservoir.site_indices.reserve(max(N_max, 0L));
+		reservoir.N_max = N_max;
+		reservoir.N_seen = 0;
+		reservoir.N_next = 0;
+		reservoir.weight = 1.0;
+	}
+
+	long int Morphology::labelDomains(vector<long int>& labels, const int max_distance_sq) const {
+		int length = lattice.getLength();
+		int width = lattice.getWidth();
+		int height = lattice.getHeight();
+		bool periodic_x = lattice.isXPeriodic();
+		bool periodic_y = lattice.isYPeriodic();
+		long int N_sites = lattice.getNumSites();
+		// Only the neighbors that come after each site in the lattice ordering are checked, so that each pair of neighboring sites is only checked once.
+		// These neighbors are split into those in the same yz-plane and those in the next yz-plane, and the site index offset of each neighbor is stored.
+		vector<NeighborOffset> plane_offsets;
+		vector<NeighborOffset> next_plane_offsets;
+		for (const auto& offset : Neighbor_stencil) {
+			if (offset.distance_sq > max_distance_sq) {
+				continue;
+			}
+			if (offset.i == 1) {
+				next_plane_offsets.push_back(offset);
+			}
+			else if (offset.i == 0 && (offset.j > 0 || (offset.j == 0 && offset.k > 0))) {
+				plane_offsets.push_back(offset);
+			}
+		}
+		// The site types are copied to a contiguous array that is read while checking the neighbors of each site.
+		vector<char> site_types(N_sites);
+		for (long int i = 0; i < N_sites; i++) {
+			site_types[i] = lattice.getSiteType(i);
+		}
+		// Each site starts as its own domain, and the parent of each site always has a lower site index, so the root of each tree is the lowest site index in the domain.
+		labels.resize(N_sites);
+		for (long int i = 0; i < N_sites; i++) {
+			labels[i] = i;
+		}
+		auto find_root = [&labels](long int index) {
+			while (labels[index] != index) {
+				labels[index] = labels[labels[index]];
+				index = labels[index];
+			}
+			return index;
+		};
+		// Merges the domains of the site at (x,y,z) and its same type neighbors given by the specified offsets.
+		auto merge_neighbors = [&](const int x, const int y, const int z, const vector<NeighborOffset>& offsets) {
+			long int site_index = (long int)x*width*height + (long int)y*height + z;
+			for (const auto& offset : offsets) {
+				int z_dest = z + offset.k;
+				if (z_dest < 0 || z_dest >= height) {
+					continue;
+				}
+				int x_dest = x + offset.i;
+				if (x_dest >= length) {
+					if (!periodic_x) {
 						continue;
 					}
-					if (!lattice.checkMoveValidity(coords, i, j, k)) {
+					x_dest -= length;
+				}
+				int y_dest = y + offset.j;
+				if (y_dest < 0 || y_dest >= width) {
+					if (!periodic_y) {
 						continue;
 					}
-					lattice.calculateDestinationCoords(coords, i, j, k, coords_dest);
-					if (lattice.getSiteType(coords) != lattice.getSiteType(coords_dest)) {
-						return true;
+					y_dest += (y_dest < 0) ? width : -width;
+				}
+				long int neighbor_index = (long int)x_dest*width*height + (long int)y_dest*height + z_dest;
+				if (site_types[neighbor_index] != site_types[site_index]) {
+					continue;
+				}
+				long int root1 = find_root(site_index);
+				long int root2 = find_root(neighbor_index);
+				if (root1 < root2) {
+					labels[root2] = root1;
+				}
+				else if (root2 < root1) {
+					labels[root1] = root2;
+				}
+			}
+		};
+		// The lattice is split into slabs of yz-planes that are labeled independently, so each thread only modifies the labels of the sites in its own slab.
+		int N_threads = 1;
+#ifdef _OPENMP
+		N_threads = omp_get_max_threads();
+#endif
+		int N_slabs = min(length, 4 * N_threads);
+		vector<int> slab_ends(N_slabs);
+		for (int s = 0; s < N_slabs; s++) {
+			slab_ends[s] = (int)(((long int)s + 1)*length / N_slabs);
+		}
+#pragma omp parallel for schedule(dynamic)
+		for (int s = 0; s < N_slabs; s++) {
+			int x_begin = (s == 0) ? 0 : slab_ends[s - 1];
+			for (int x = x_begin; x < slab_ends[s]; x++) {
+				for (int y = 0; y < width; y++) {
+					for (int z = 0; z < height; z++) {
+						merge_neighbors(x, y, z, plane_offsets);
+						if (x < slab_ends[s] - 1) {
+							merge_neighbors(x, y, z, next_plane_offsets);
+						}
 					}
 				}
 			}
 		}
-		return false;
+		// The domains are then merged across the slab boundaries, including the periodic boundary between the last and first slabs.
+		for (int s = 0; s < N_slabs; s++) {
+			for (int y = 0; y < width; y++) {
+				for (int z = 0; z < height; z++) {
+					merge_neighbors(slab_ends[s] - 1, y, z, next_plane_offsets);
+				}
+			}
+		}
+		// Each root is assigned the next domain label, and all other sites are given the label of their parent, which has already been relabeled.
+		long int N_domains = 0;
+		for (long int i = 0; i < N_sites; i++) {
+			if (labels[i] == i) {
+				labels[i] = N_domains;
+				N_domains++;
+			}
+			else {
+				labels[i] = labels[labels[i]];
+			}
+		}
+		return N_domains;
+	}
+
+	void Morphology::loadTomogramData(TomogramData& tomogram_data) {
+		string metadata_filename = Params.Tomogram_name + ".xml";
+		string data_filename = Params.Tomogram_name + ".raw";
+		// Parse XML metadata file
+		cout << ID << ": Loading and Parsing the XML metadata file..." << endl;
+		XMLDocument xml_doc;
+		string data_format;
+		FILE* xml_file_ptr;
+		xml_file_ptr = fopen(metadata_filename.c_str(), "rb");
+		if (xml_file_ptr == NULL) {
+			cout << ID << ": Error! XML metadata file not found." << endl;
+			throw runtime_error("Error! XML metadata file not found.");
+		}
+		xml_doc.LoadFile(xml_file_ptr);
+		if (xml_doc.Error()) {
+			xml_doc.PrintError();
+			cout << ID << ": Error loading XML metadata file." << endl;
+			throw runtime_error("Error loading XML metadata file.");
+		}
+		// Analyze XML info file based on metadata format version
+		Version required_version("1.0.0");
+		string schema_version_str = xml_doc.FirstChildElement("tomogram_metadata")->Attribute("schema_version");
+		Version schema_version(schema_version_str);
+		// Initialize lattice params based on xml data
+		Lattice::Lattice_Params lattice_params;
+		if (schema_version == required_version) {
+			lattice_params.Length = atoi(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("length")->GetText());
+			lattice_params.Width = atoi(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("width")->GetText());
+			lattice_params.Height = atoi(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("height")->GetText());
+			lattice_params.Unit_size = atof(xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("pixel_size")->FirstChildElement("value")->GetText());
+			// Save additional xml data needed
+			data_format = xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("data_info")->FirstChildElement("data_format")->GetText();
+			if (data_format.compare("8 bit") != 0 && data_format.compare("16 bit") != 0) {
+				cout << "Error! The xml metadata file does not specify a valid data format. Only 8 bit and 16 bit formats are supported." << endl;
+				throw runtime_error("Error! The xml metadata file does not specify a valid data format. Only 8 bit and 16 bit formats are supported.");
+			}
+			// Initialize Morphology site types
+			int site_type_index = 0;
+			XMLElement* element_ptr = xml_doc.FirstChildElement("tomogram_metadata")->FirstChildElement("sample_info")->FirstChildElement("composition_info")->FirstChildElement("chemical_component");
+			while (element_ptr != 0) {
+				addSiteType((char)(site_type_index + 1));
+				Mix_fractions[site_type_index] = atof(element_ptr->FirstChildElement("vol_frac")->GetText());
+				element_ptr = element_ptr->NextSiblingElement("chemical_component");
+				site_type_index++;
+			}
+		}
+		else {
+			cout << ID << ": Error! XML metadata schema version not supported. Only v1.0.0 is supported." << endl;
+			throw runtime_error("Error! XML metadata schema version not supported. Only v1.0.0 is supported.");
+		}
+		fclose(xml_file_ptr);
+		double Mix_fraction_import = Mix_fractions[0];
+		// Map the data file, so that the voxels are read in their native 8 bit or 16 bit format as they are needed
+		cout << ID << ": Loading RAW data file..." << endl;
+		MappedFile data_file;
+		if (!data_file.open(data_filename)) {
+			cout << ID << ": Error! Tomogram binary RAW file " << data_filename << " could not be opened." << endl;
+			throw runtime_error("Error! Tomogram binary RAW file could not be opened.");
+		}
+		size_t bytes_per_voxel = (data_format.compare("8 bit") == 0) ? 1 : 2;
+		size_t N_voxels = data_file.size() / bytes_per_voxel;
+		// Check amount of data in the RAW file
+		if (N_voxels != (size_t)lattice_params.Length*(size_t)lattice_params.Width*(size_t)lattice_params.Height) {
+			cout << "Error! The imported tomogram RAW file does not contain the correct number of sites." << endl;
+			cout << "The initial lattice has " << (size_t)lattice_params.Length*(size_t)lattice_params.Width*(size_t)lattice_params.Height << " sites but the data file has " << N_voxels << " entries." << endl;
+			throw runtime_error("Error! The imported tomogram RAW file does not contain the correct number of sites.");
+		}
+		// Construct lattice with desired unit size
+		cout << ID << ": Interpolating data to construct final lattice..." << endl;
+		// Determine final lattice dimensions based on desired unit size
+		Lattice::Lattice_Params lattice_params_initial = lattice_params;
+		lattice_params.Length = (int)floor(lattice_params.Length*(lattice_params.Unit_size / Params.Desired_unit_size));
+		lattice_params.Width = (int)floor(lattice_params.Width*(lattice_params.Unit_size / Params.Desired_unit_size));
+		lattice_params.Height = (int)floor(lattice_params.Height*(lattice_params.Unit_size / Params.Desired_unit_size));
+		lattice_params.Unit_size = Params.Desired_unit_size;
+		tomogram_data.lattice_params_initial = lattice_params_initial;
+		tomogram_data.lattice_params = lattice_params;
+		tomogram_data.bytes_per_voxel = (int)bytes_per_voxel;
+		tomogram_data.mix_fraction = Mix_fraction_import;
+		const int length = lattice_params.Length;
+		const int width = lattice_params.Width;
+		const int height = lattice_params.Height;
+		// Without tiled processing, the whole lattice is interpolated as a single brick
+		tomogram_data.brick_height = height;
+		if (Params.Enable_tiled_tomogram_import) {
+			// Each plane of a brick needs its interpolated values and scratch file data, and the RAW file planes and interpolation slab buffers used to calculate it
+			int N_threads = 1;
+#ifdef _OPENMP
+			N_threads = omp_get_max_threads();
+#endif
+			double input_planes = lattice_params.Unit_size / lattice_params_initial.Unit_size;
+			double plane_bytes = (double)length*width*(sizeof(float) + 1) + input_planes * ((double)lattice_params_initial.Length*lattice_params_initial.Width*bytes_per_voxel + (double)N_threads*(lattice_params_initial.Width + width)*sizeof(float));
+			double budget_bytes = (double)Params.Tomogram_tile_budget * 1024 * 1024;
+			tomogram_data.brick_height = max(1, min(height, (int)floor(budget_bytes / plane_bytes)));
+		}
+		// Use pixel brightness cutoff method to assign site types, dark sites are type2 and bright sites are type1
+		cout << ID << ": Analyzing pixel brightness to assign site types..." << endl;
+		// Determine number of each type of site
+		long int N_sites = (long int)length*width*height;
+		long int N_type1_total = (long int)(Mix_fraction_import * N_sites + 0.5);
+		long int N_type2_total = N_sites - N_type1_total;
+		long int N_mixed_total = (long int)(Params.Mixed_frac * N_sites + 0.5);
+		long int N_type1_mixed = (long int)(Params.Mixed_conc * N_mixed_total + 0.5);
+		tomogram_data.N_mixed = N_mixed_total;
+		tomogram_data.N_type1_mixed = N_type1_mixed;
+		long int N_type2_pure = N_type2_total - (N_mixed_total - N_type1_mixed);
+		long int N_type1_pure = N_type1_total - N_type1_mixed;
+		// Find the brightness thresholds below which the pure type2 sites and the pure type2 and mixed sites lie
+		// The data is rotated to the standard Ising_OPV reference frame as it is interpolated
+		vector<float> brick;
+		calculateBrightnessThresholds({ N_type2_pure, N_sites - N_type1_pure }, data_file, brick, tomogram_data);
+		// With tiled processing, the sites are only classified while the segments are created
+		if (Params.Enable_tiled_tomogram_import) {
+			return;
+		}
+		// Assign the pure sites and collect the indices of the sites in the mixed brightness band in classification order
+		vector<char>& site_types = tomogram_data.site_types;
+		vector<long int>& mixed_indices = tomogram_data.mixed_indices;
+		site_types.assign(N_sites, (char)0);
+		mixed_indices.clear();
+		mixed_indices.reserve(max(N_mixed_total, 0L));
+		vector<long int> tie_counts(2, 0);
+		processTomogramBricks(tomogram_data, data_file, brick, [&](const int z_start, const int z_end) {
+			classifyTomogramBrick(tomogram_data, brick, z_start, z_end, tie_counts, [&](const int i, const int j, const int k, const char site_type) {
+				long int site_index = ((long int)i*width + j)*height + k;
+				site_types[site_index] = site_type;
+				if (site_type == 0) {
+					mixed_indices.push_back(site_index);
+				}
+			});
+		});
 	}
 
 	void Morphology::outputCompositionMaps(ofstream& outfile) const {
@@ -2397,6 +4145,14 @@ namespace Ising_OPV {
 			}
 			outfile << endl;
 		}
+		// The achieved domain size error is recorded after the correlation data when the progressive calculation is used
+		if (Params.Enable_progressive_correlation_calc) {
+			outfile << endl;
+			outfile << "Site_type,Domain_size (a),Domain_size_error (a),N_sites" << endl;
+			for (int n = 0; n < (int)Site_types.size(); n++) {
+				outfile << (int)Site_types[n] << "," << Domain_sizes[n] << "," << Domain_size_errors[n] << "," << Correlation_site_counts[n] << endl;
+			}
+		}
 	}
 
 	void Morphology::outputDepthDependentData(ofstream& outfile) const {
@@ -2435,6 +4191,58 @@ namespace Ising_OPV {
 		//}
 	}
 
+	void Morphology::outputMorphologyBinaryFile(ofstream& outfile) const {
+		int num_types = (int)Site_types.size();
+		int bits_per_site = (num_types <= 2) ? 1 : ((num_types <= 4) ? 2 : 8);
+		int sites_per_byte = 8 / bits_per_site;
+		// The signature is followed by the format version, lattice dimensions, periodic boundary options, number of site types, and number of bits per site
+		int header[9] = { Binary_file_format_version, lattice.getLength(), lattice.getWidth(), lattice.getHeight(), (int)lattice.isXPeriodic(), (int)lattice.isYPeriodic(), (int)lattice.isZPeriodic(), num_types, bits_per_site };
+		outfile.write(Binary_file_signature, 8);
+		outfile.write((const char*)header, sizeof(header));
+		// The site type values are stored in the order of the Site_types vector, so that the domain size, mix fraction, and packed index of each site type can be mapped back to the site type on import
+		outfile.write(Site_types.data(), num_types);
+		outfile.write((const char*)Domain_sizes.data(), num_types * sizeof(double));
+		outfile.write((const char*)Mix_fractions.data(), num_types * sizeof(double));
+		// The site type indices are packed in site index order and written in blocks
+		array<unsigned char, 256> type_indices;
+		type_indices.fill(0);
+		for (int n = 0; n < num_types; n++) {
+			type_indices[(unsigned char)Site_types[n]] = (unsigned char)n;
+		}
+		const size_t block_size = 1 << 20;
+		vector<unsigned char> block;
+		block.reserve(block_size);
+		long int N_sites = lattice.getNumSites();
+		for (long int n = 0; n < N_sites; n += sites_per_byte) {
+			unsigned char byte = 0;
+			for (int i = 0; i < sites_per_byte && n + i < N_sites; i++) {
+				byte |= (unsigned char)(type_indices[(unsigned char)lattice.getSiteType(n + i)] << (i*bits_per_site));
+			}
+			block.push_back(byte);
+			if (block.size() == block_size) {
+				outfile.write((const char*)block.data(), block.size());
+				block.clear();
+			}
+		}
+		outfile.write((const char*)block.data(), block.size());
+	}
+
+	void Morphology::outputMorphologyBuffer(vector<char>& buffer) const {
+		// The buffer header contains the lattice dimensions, periodic boundary options, and number of site types
+		int header[7] = { lattice.getLength(), lattice.getWidth(), lattice.getHeight(), (int)lattice.isXPeriodic(), (int)lattice.isYPeriodic(), (int)lattice.isZPeriodic(), (int)Site_types.size() };
+		size_t data_offset = sizeof(header) + Site_types.size() + 2 * Site_types.size() * sizeof(double);
+		buffer.resize(data_offset + (size_t)lattice.getNumSites());
+		memcpy(buffer.data(), header, sizeof(header));
+		// The header is followed by the value, domain size, and mix fraction of each site type in the order of the Site_types vector
+		memcpy(buffer.data() + sizeof(header), Site_types.data(), Site_types.size());
+		memcpy(buffer.data() + sizeof(header) + Site_types.size(), Domain_sizes.data(), Site_types.size() * sizeof(double));
+		memcpy(buffer.data() + sizeof(header) + Site_types.size() + Site_types.size() * sizeof(double), Mix_fractions.data(), Site_types.size() * sizeof(double));
+		// The type of each site is stored last
+		for (long int n = 0; n < lattice.getNumSites(); n++) {
+			buffer[data_offset + n] = lattice.getSiteType(n);
+		}
+	}
+
 	void Morphology::outputMorphologyFile(ofstream& outfile, bool enable_export_compressed) const {
 		if (enable_export_compressed) {
 			outfile << "Ising_OPV v" << Current_version.getVersionStr() << " - compressed format" << endl;
@@ -2507,6 +4315,31 @@ namespace Ising_OPV {
 		}
 	}
 
+	void Morphology::processTomogramBricks(const TomogramData& tomogram_data, MappedFile& data_file, vector<float>& brick, const function<void(const int, const int)>& brick_function) const {
+		const Lattice::Lattice_Params& params_initial = tomogram_data.lattice_params_initial;
+		const Lattice::Lattice_Params& params_final = tomogram_data.lattice_params;
+		const int height = params_final.Height;
+		if (tomogram_data.brick_height >= height && brick.size() == (size_t)params_final.Length*params_final.Width*height) {
+			brick_function(0, height);
+			return;
+		}
+		for (int z_start = 0; z_start < height; z_start += tomogram_data.brick_height) {
+			int z_end = min(z_start + tomogram_data.brick_height, height);
+			if (tomogram_data.bytes_per_voxel == 1) {
+				interpolateTomogramData((const unsigned char*)data_file.data(), params_initial, params_final, Params.Tomogram_interpolation_order, z_start, z_end, brick);
+			}
+			else {
+				interpolateTomogramData((const char16_t*)data_file.data(), params_initial, params_final, Params.Tomogram_interpolation_order, z_start, z_end, brick);
+			}
+			brick_function(z_start, z_end);
+			// Release the RAW file planes below the next brick, which uses at most two planes below the input position of its first plane
+			if (tomogram_data.brick_height < height) {
+				int z_input = (z_end < height) ? max(0, (int)floor(z_end * params_final.Unit_size / params_initial.Unit_size) - 2) : params_initial.Height;
+				data_file.release(0, (size_t)z_input*params_initial.Length*params_initial.Width*tomogram_data.bytes_per_voxel);
+			}
+		}
+	}
+
 	void Morphology::shrinkLattice(int rescale_factor) {
 		// Error handling
 		if (rescale_factor == 0) {
@@ -2517,54 +4350,97 @@ namespace Ising_OPV {
 			cout << "Error! All lattice dimensions are not divisible by the rescale factor." << endl;
 			throw invalid_argument("Error! All lattice dimensions are not divisible by the rescale factor.");
 		}
-		// Clear existing Site_type_counts data
-		for (int n = 0; n < (int)Site_types.size(); n++) {
-			Site_type_counts[n] = 0;
-		}
-		// Construct the smaller lattice 
-		Lattice lattice_rescale = lattice;
-		lattice_rescale.resize(lattice.getLength() / rescale_factor, lattice.getWidth() / rescale_factor, lattice.getHeight() / rescale_factor);
-		// Assign site types to the new lattice based on the existing lattice
-		int type1_count;
-		bool alternate = true;
-		char target_site_type;
-		for (int x = 0; x < lattice_rescale.getLength(); x++) {
-			for (int y = 0; y < lattice_rescale.getWidth(); y++) {
-				for (int z = 0; z < lattice_rescale.getHeight(); z++) {
-					type1_count = 0;
-					for (int i = rescale_factor * x; i < (rescale_factor*x + rescale_factor); i++) {
-						for (int j = rescale_factor * y; j < (rescale_factor*y + rescale_factor); j++) {
-							for (int k = rescale_factor * z; k < (rescale_factor*z + rescale_factor); k++) {
-								if (lattice.getSiteType(i, j, k) == (char)1) {
-									type1_count++;
+		const int length_new = lattice.getLength() / rescale_factor;
+		const int width_new = lattice.getWidth() / rescale_factor;
+		const int height_new = lattice.getHeight() / rescale_factor;
+		const int height = lattice.getHeight();
+		const long int plane_size = (long int)lattice.getWidth()*height;
+		const long int plane_size_new = (long int)width_new*height_new;
+		const int block_volume = rescale_factor * rescale_factor*rescale_factor;
+		// Only the site types of the smaller lattice are allocated, and each site is assigned the majority type of the corresponding block of sites in the existing lattice.
+		// Blocks with an equal number of type 1 and type 2 sites are marked with a zero and assigned in a second pass.
+		vector<char> site_types_new(length_new*plane_size_new);
+		vector<long int> tie_counts(length_new, 0);
+#pragma omp parallel
+		{
+			vector<int> type1_counts(height_new);
+#pragma omp for
+			for (int x = 0; x < length_new; x++) {
+				for (int y = 0; y < width_new; y++) {
+					fill(type1_counts.begin(), type1_counts.end(), 0);
+					// The block counts for the whole z-line are accumulated from the z-lines of the existing lattice that make up the blocks.
+					for (int i = rescale_factor * x; i < rescale_factor*(x + 1); i++) {
+						for (int j = rescale_factor * y; j < rescale_factor*(y + 1); j++) {
+							long int line_index = i * plane_size + (long int)j*height;
+							for (int z = 0; z < height_new; z++) {
+								for (int k = rescale_factor * z; k < rescale_factor*(z + 1); k++) {
+									if (lattice.getSiteType(line_index + k) == (char)1) {
+										type1_counts[z]++;
+									}
 								}
 							}
 						}
 					}
-					if (2 * type1_count > (rescale_factor*rescale_factor*rescale_factor)) {
-						target_site_type = (char)1;
-					}
-					else if (2 * type1_count < (rescale_factor*rescale_factor*rescale_factor)) {
-						target_site_type = (char)2;
-					}
-					else {
-						if (alternate) {
-							target_site_type = (char)1;
+					long int site_index_new = x * plane_size_new + (long int)y*height_new;
+					for (int z = 0; z < height_new; z++) {
+						if (2 * type1_counts[z] > block_volume) {
+							site_types_new[site_index_new + z] = (char)1;
+						}
+						else if (2 * type1_counts[z] < block_volume) {
+							site_types_new[site_index_new + z] = (char)2;
 						}
 						else {
-							target_site_type = (char)2;
+							site_types_new[site_index_new + z] = (char)0;
+							tie_counts[x]++;
 						}
-						alternate = !alternate;
 					}
-					lattice_rescale.setSiteType(x, y, z, target_site_type);
-					Site_type_counts[getSiteTypeIndex(target_site_type)]++;
 				}
 			}
 		}
+		// Ties are broken by alternating between type 1 and type 2 in site index order, starting with type 1.
+		// The number of ties before each x-slab is found from the tie counts, so that the slabs can be processed in parallel and the result does not depend on the number of threads.
+		vector<long int> tie_offsets(length_new, 0);
+		if (length_new > 0) {
+			partial_sum(tie_counts.begin(), tie_counts.end() - 1, tie_offsets.begin() + 1);
+		}
+		// The sites of each type are counted by their char value in the same way as in stretchLattice, so that only the site types present in the smaller lattice are assigned.
+		vector<long int> type_counts(256, 0);
+#pragma omp parallel
+		{
+			vector<long int> type_counts_local(256, 0);
+#pragma omp for
+			for (int x = 0; x < length_new; x++) {
+				long int tie_index = tie_offsets[x];
+				for (long int n = x * plane_size_new; n < (x + 1)*plane_size_new; n++) {
+					if (site_types_new[n] == (char)0) {
+						site_types_new[n] = (tie_index % 2 == 0) ? (char)1 : (char)2;
+						tie_index++;
+					}
+					type_counts_local[(unsigned char)site_types_new[n]]++;
+				}
+			}
+#pragma omp critical
+			{
+				for (int n = 0; n < 256; n++) {
+					type_counts[n] += type_counts_local[n];
+				}
+			}
+		}
+		// The shrinking process can change the mix fraction, so the Site_type_counts and Mix_fraction properties are updated.
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Site_type_counts[n] = 0;
+		}
+		for (int n = 0; n < 256; n++) {
+			if (type_counts[n] > 0) {
+				Site_type_counts[getSiteTypeIndex((char)n)] = (int)type_counts[n];
+			}
+		}
 		// Update the lattice
-		lattice = lattice_rescale;
-		// The shrinking process can change the mix fraction, so the Mix_fraction property is updated.
-		calculateMixFractions();
+		lattice.resize(length_new, width_new, height_new);
+		lattice.setSiteTypes(site_types_new);
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Mix_fractions[n] = (double)Site_type_counts[n] / (double)lattice.getNumSites();
+		}
 	}
 
 	void Morphology::stretchLattice(int rescale_factor) {
@@ -2572,32 +4448,58 @@ namespace Ising_OPV {
 			cout << "Error! Lattice cannot be stretched by a rescale factor of zero." << endl;
 			throw invalid_argument("Error! Lattice cannot be streched by a rescale factor of zero.");
 		}
-		// Clear existing Site_type_counts data
-		for (int n = 0; n < (int)Site_types.size(); n++) {
-			Site_type_counts[n] = 0;
-		}
-		// Construct the larger lattice
-		Lattice lattice_rescale = lattice;
-		lattice_rescale.resize(lattice.getLength()*rescale_factor, lattice.getWidth()*rescale_factor, lattice.getHeight()*rescale_factor);
-		// Assign site types to the new lattice based on the existing lattice
-		for (int x = 0; x < lattice.getLength(); x++) {
-			for (int y = 0; y < lattice.getWidth(); y++) {
-				for (int z = 0; z < lattice.getHeight(); z++) {
-					for (int i = rescale_factor * x; i < rescale_factor*x + rescale_factor; i++) {
-						for (int j = rescale_factor * y; j < rescale_factor*y + rescale_factor; j++) {
-							for (int k = rescale_factor * z; k < rescale_factor*z + rescale_factor; k++) {
-								lattice_rescale.setSiteType(i, j, k, lattice.getSiteType(x, y, z));
-								Site_type_counts[getSiteTypeIndex(lattice.getSiteType(x, y, z))]++;
-							}
+		const int length = lattice.getLength();
+		const int width = lattice.getWidth();
+		const int height = lattice.getHeight();
+		const int height_new = height * rescale_factor;
+		const long int plane_size_new = (long int)width*rescale_factor*height_new;
+		// Only the site types of the larger lattice are allocated.
+		// Each z-line of the existing lattice is stretched once and then copied to all of the z-lines of the larger lattice in the corresponding block.
+		vector<char> site_types_new(length*rescale_factor*plane_size_new);
+		// The sites of each type are counted by their char value and then assigned to the Site_type_counts once the counts of all threads are combined.
+		vector<long int> type_counts(256, 0);
+#pragma omp parallel
+		{
+			vector<char> line_new(height_new);
+			vector<long int> type_counts_local(256, 0);
+#pragma omp for
+			for (int x = 0; x < length; x++) {
+				for (int y = 0; y < width; y++) {
+					long int line_index = lattice.getSiteIndex(x, y, 0);
+					for (int z = 0; z < height; z++) {
+						char site_type = lattice.getSiteType(line_index + z);
+						fill(line_new.begin() + z * rescale_factor, line_new.begin() + (z + 1)*rescale_factor, site_type);
+						type_counts_local[(unsigned char)site_type]++;
+					}
+					for (int i = rescale_factor * x; i < rescale_factor*(x + 1); i++) {
+						for (int j = rescale_factor * y; j < rescale_factor*(y + 1); j++) {
+							copy(line_new.begin(), line_new.end(), site_types_new.begin() + (i*plane_size_new + (long int)j*height_new));
 						}
 					}
 				}
 			}
+#pragma omp critical
+			{
+				for (int n = 0; n < 256; n++) {
+					type_counts[n] += type_counts_local[n];
+				}
+			}
+		}
+		// The stretch process can change the mix fraction, so the Site_type_counts and Mix_fraction properties are updated.
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Site_type_counts[n] = 0;
+		}
+		for (int n = 0; n < 256; n++) {
+			if (type_counts[n] > 0) {
+				Site_type_counts[getSiteTypeIndex((char)n)] = (int)(type_counts[n] * rescale_factor*rescale_factor*rescale_factor);
+			}
 		}
 		// Update the lattice
-		lattice = lattice_rescale;
-		// The stretch process can change the mix fraction, so the Mix_fraction property is updated.
-		calculateMixFractions();
+		lattice.resize(length*rescale_factor, width*rescale_factor, height_new);
+		lattice.setSiteTypes(site_types_new);
+		for (int n = 0; n < (int)Site_types.size(); n++) {
+			Mix_fractions[n] = (double)Site_type_counts[n] / (double)lattice.getNumSites();
+		}
 	}
 
 	double Morphology::rand01() {
@@ -2609,6 +4511,12 @@ namespace Ising_OPV {
 			cout << ID << ": Error! Input parameters are invalid." << endl;
 			throw invalid_argument("Error! Input parameters are invalid.");
 		}
+		// The loaded tomogram data depends on the tomogram import options, so it is released and reloaded on the next tomogram import when any of these options change
+		if (params.Tomogram_name != Params.Tomogram_name || params.Desired_unit_size != Params.Desired_unit_size || params.Tomogram_interpolation_order != Params.Tomogram_interpolation_order
+			|| params.Enable_tiled_tomogram_import != Params.Enable_tiled_tomogram_import || params.Tomogram_tile_budget != Params.Tomogram_tile_budget
+			|| params.Mixed_frac != Params.Mixed_frac || params.Mixed_conc != Params.Mixed_conc) {
+			Tomogram_data.reset();
+		}
 		Params = params;
 	}
 
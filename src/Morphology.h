@@ -14,12 +14,16 @@
 #include <algorithm>
 #include <array>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <functional>
+#include <limits>
 #include <numeric>
+#include <queue>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_set>
 
 namespace Ising_OPV {
 
@@ -39,18 +43,49 @@ namespace Ising_OPV {
 			long int site_index;
 		};
 
-		struct NodeIteratorCompare {
-			bool operator()(const std::vector<Node>::const_iterator& a, const std::vector<Node>::const_iterator& b) const {
-				if (a == b) {
-					return false;
-				}
-				else if (a->distance_est == b->distance_est) {
-					return a < b;
-				}
-				else {
-					return a->distance_est < b->distance_est;
-				}
-			}
+		// Data structure that stores the relative position and squared distance of a neighboring site
+		struct NeighborOffset {
+			int i;
+			int j;
+			int k;
+			int distance_sq;
+		};
+
+		// Offsets of the 26 first-, second-, and third-nearest neighbors of a site, ordered by increasing i, then j, then k
+		static constexpr NeighborOffset Neighbor_stencil[26] = {
+			{ -1,-1,-1,3 },{ -1,-1,0,2 },{ -1,-1,1,3 },{ -1,0,-1,2 },{ -1,0,0,1 },{ -1,0,1,2 },{ -1,1,-1,3 },{ -1,1,0,2 },{ -1,1,1,3 },
+			{ 0,-1,-1,2 },{ 0,-1,0,1 },{ 0,-1,1,2 },{ 0,0,-1,1 },{ 0,0,1,1 },{ 0,1,-1,2 },{ 0,1,0,1 },{ 0,1,1,2 },
+			{ 1,-1,-1,3 },{ 1,-1,0,2 },{ 1,-1,1,3 },{ 1,0,-1,2 },{ 1,0,0,1 },{ 1,0,1,2 },{ 1,1,-1,3 },{ 1,1,0,2 },{ 1,1,1,3 }
+		};
+
+		// Squared distance value that marks sites without a known distance in the distance transform
+		static constexpr int Infinite_distance_sq = std::numeric_limits<int>::max();
+
+		// Number of random starting sites in each batch of the progressive correlation calculation
+		static constexpr int Correlation_batch_size = 1000;
+
+		// Minimum number of batches used by the progressive correlation calculation before its standard error is checked
+		static constexpr int Correlation_batches_min = 5;
+
+		// Signature at the start of binary morphology files, of which the first 8 characters are written to the file
+		static constexpr char Binary_file_signature[9] = "IsingOPV";
+
+		// Version of the binary morphology file format, which must be incremented whenever the layout of the file changes
+		static constexpr int Binary_file_format_version = 1;
+
+		// Data structure that stores the working arrays of the one-dimensional distance transform, so that they can be reused for each line of the lattice
+		struct DistanceTransformData {
+			std::vector<int> values;
+			std::vector<int> vertices;
+			std::vector<double> boundaries;
+		};
+
+		// Data structure that stores the volume and site type of a connected domain and whether it touches the bottom (z=0) or top (z=Height-1) surface
+		struct DomainData {
+			long int volume = 0;
+			char site_type = 0;
+			bool is_bottom_connected = false;
+			bool is_top_connected = false;
 		};
 
 		// Data structure that stores counts of the number of neighbors that have the same site type as the main site
@@ -75,6 +110,55 @@ namespace Ising_OPV {
 			char total3;
 		};
 
+		// Data structure that stores the unnormalized direction dependent pair-pair correlation sums for one site type
+		// Keeping these partial sums allows the anisotropy calculation to be resumed with a larger cutoff distance by only calculating the new distances
+		// N_sites keeps track of the number of starting sites included in the sums
+		struct AnisotropyData {
+			std::vector<double> correlation_x;
+			std::vector<double> correlation_y;
+			std::vector<double> correlation_z;
+			int N_sites = 0;
+		};
+
+		// Data structure that holds a uniform random sample of at most N_max site indices drawn from a stream of candidate sites
+		// N_seen keeps track of the number of candidate sites that have been offered to the reservoir
+		// N_next is the stream position of the next candidate site that will replace a site in the full reservoir
+		// weight is the running weight used to generate the geometric skip lengths of Li's Algorithm L
+		struct SiteReservoir {
+			std::vector<long int> site_indices;
+			long int N_max = 0;
+			long int N_seen = 0;
+			long int N_next = 0;
+			double weight = 1.0;
+		};
+
+		// Data structure that stores the result of loading and analyzing a tomogram, so that new variants of the mixed phase can be created without repeating the analysis
+		// lattice_params_initial describes the RAW data file with bytes_per_voxel bytes per voxel, lattice_params describes the final lattice, and the data is interpolated in z-bricks of brick_height planes
+		// Sites are classified using the lower and upper brightness thresholds, each given by a threshold key and the number of sites with that key that are below the threshold
+		// Unless tiled processing is enabled, site_types holds the pure phase site types with zero for the mixed phase sites, whose indices are stored in the classification order in mixed_indices
+		// N_type1_mixed of the N_mixed mixed phase sites are assigned as type1, and mix_fraction is the type1 volume fraction designated in the xml metadata file
+		struct TomogramData {
+			Lattice::Lattice_Params lattice_params_initial;
+			Lattice::Lattice_Params lattice_params;
+			int bytes_per_voxel = 1;
+			int brick_height = 0;
+			std::vector<unsigned int> threshold_keys;
+			std::vector<long int> N_threshold_ties;
+			std::vector<char> site_types;
+			std::vector<long int> mixed_indices;
+			long int N_mixed = 0;
+			long int N_type1_mixed = 0;
+			double mix_fraction = 0.0;
+		};
+
+		// Data structure that stores the one-dimensional resampling table of one lattice axis
+		// For each output position, N_taps input indices and their interpolation weights are stored consecutively
+		struct ResamplingTable {
+			int N_taps = 0;
+			std::vector<int> indices;
+			std::vector<double> weights;
+		};
+
 	public:
 		// Functions
 
@@ -101,6 +185,12 @@ namespace Ising_OPV {
 		//! \brief Calculates the domain size anisotropy of each phase 
 		void calculateAnisotropies();
 
+		//! \brief Calculates the chord length distributions of each site type in the x-, y-, and z-directions.
+		//! \details A chord is a continuous run of sites of the same type along a line parallel to one of the lattice axes.
+		//! The chords are found with run-length scans of every lattice line, and runs that cross a periodic boundary are joined into a single chord.
+		//! Chords that end at a non-periodic boundary are truncated at the boundary.
+		void calculateChordLengthDistributions();
+
 		//! \brief Calculates the correlation length data and the domain size using the input parameter options.
 		void calculateCorrelationDistances();
 
@@ -108,11 +198,23 @@ namespace Ising_OPV {
 		//! \details Calculates the depth dependent composition, interfacial volume fraction, and domain size.
 		void calculateDepthDependentData();
 
+		//! \brief Labels the connected domains of each site type and calculates the domain volume distributions and the connectivity of the domains to the electrodes.
+		//! \details Sites are connected to their same type neighbors, and domains can cross the periodic x and y boundaries, but not the z boundaries.
+		//! The z=0 surface is the electrode for type 1 sites, and the z=Height-1 surface is the electrode for type 2 sites.
+		//! A site type percolates when at least one of its domains touches both surfaces.
+		//! The domains are labeled in a single near-linear pass using a union-find algorithm, where slabs of the lattice are labeled in parallel and then merged.
+		//! \param N_neighbors is the number of neighbors that each site can be connected to, which must be 6 (first-nearest), 18 (up to second-nearest), or 26 (up to third-nearest).
+		//! \return true if the calculation was successful.
+		//! \return false if N_neighbors is not 6, 18, or 26.
+		bool calculateDomainConnectivity(const int N_neighbors);
+
 		//! \brief Calculates the interfacial area in units of lattice units squared.
 		double calculateInterfacialAreaVolumeRatio() const;
 
 		//! \brief Calculates the interfacial distance histograms, which gives the fraction of sites at a specified distance from the interface.
-		void calculateInterfacialDistanceHistogram();
+		//! \param enable_chamfer_distances sets whether the distances are calculated as the shortest paths through same type sites using the 26-neighbor chamfer distances,
+		//! which reproduces the interfacial distances from versions before the exact Euclidean distance transform was introduced.
+		void calculateInterfacialDistanceHistogram(const bool enable_chamfer_distances);
 
 		//! \brief Calculates the fraction of sites adjacent to an interface.
 		double calculateInterfacialVolumeFraction() const;
@@ -120,12 +222,25 @@ namespace Ising_OPV {
 		//! \brief Calculates the volume fraction of each type site in the lattice to the total number of sites.
 		void calculateMixFractions();
 
-		//! \brief Calculates the tortuosity histogram for the specified site type.
+		//! \brief Calculates the end-to-end tortuosity data and the island volume of both site types.
 		//! \details For all type 1 sites, the shortest paths through other type 1 sites to the boundary at z=0 is calculated.
 		//! For all type 2 sites, the shortest pathes through other type 2 sites to the boundary at z=Height-1 is calculated.
-		//! The shortest paths are calculated using Dijkstra's algorithm.
+		//! The shortest paths are calculated using Dijkstra's algorithm, and the path distances for both site types are determined in a single pathfinding pass.
+		//! With the standard method, the island sites are found by labeling the connected domains, and the pathfinding is skipped for site types that do not percolate.
+		//! With the reduced memory and out-of-core methods, the island sites are the sites that are not reached by the pathfinding.
+		//! \param enable_reduced_memory allows users to choose to use a slower algorithm that uses less RAM.
+		//! \param enable_out_of_core allows users to choose to store the path distance data in a memory-mapped scratch file in the working directory,
+		//! so that only the part of the data near the current pathfinding front is kept in RAM.  This option takes precedence over enable_reduced_memory.
+		//! \return true if the calculation was successful.
+		//! \return false if the path distances could not be calculated.
+		bool calculateTortuosities(const bool enable_reduced_memory, const bool enable_out_of_core);
+
+		//! \brief Calculates the tortuosity histogram for the specified site type.
+		//! \details Only the pathfinding for the specified site type is performed, and only the tortuosity data and island volume of that site type are updated.
+		//! Use calculateTortuosities to calculate the data of both site types with a single pathfinding pass.
 		//! \param site_type specifies which site type to perform the tortuosity calculation on.
 		//! \param enable_reduced_memory allows users to choose to use a slower algorithm that uses less RAM.
+		//! \return false if the site type is not 1 or 2 or if the calculation was not successful.
 		bool calculateTortuosity(const char site_type, const bool enable_reduced_memory);
 
 		//! \brief Creates a split bilayer morphology in the z-direction.
@@ -163,9 +278,27 @@ namespace Ising_OPV {
 		//! \details Smoothing is done by determining a roughness factor for each site that is given by the fraction of surrounding sites that are a different type.
 		//! Sites with a roughness factor is greater than the specified smoothing_threshold are switched to the opposite type.
 		//! A rescale dependent smoothing process is executed when the rescale factor is greater than 2.
+		//! Only sites near the most recent type changes are reevaluated as the process iterates.
+		//! By default, sites are processed in lattice order, and when parallel smoothing is enabled, the lattice is divided into blocks sized to the smoothing radius that are processed concurrently.
+		//! The parallel process gives the same result regardless of the number of threads, but the result is not identical to that of the serial process.
 		//! \param smoothing_threshold is the numerical parameter used to adjust how aggressive the smoothing should be.
 		//! \param rescale_factor specifies whether the smoothing algorithm should be adjust to account for prior lattice rescaling by giving the rescaling factor used. 
-		void executeSmoothing(const double smoothing_threshold, const int rescale_factor);
+		//! \param enable_parallel specifies whether the smoothing should be performed in parallel using the block decomposition.
+		void executeSmoothing(const double smoothing_threshold, const int rescale_factor, const bool enable_parallel);
+
+		//! \brief Returns a vector containing the chord length histogram data for the specified site type and direction.
+		//! \details The histogram bins are the chord lengths in lattice units, from 1 to the lattice size in the specified direction.
+		//! \param site_type specifies for which site type the data should be retrieved.
+		//! \param direction specifies the direction of the chords, with 1 = x-direction, 2 = y-direction, and 3 = z-direction.
+		//! \return a copy of the data vector.
+		std::vector<std::pair<double, int>> getChordLengthHistogram(const char site_type, const int direction) const;
+
+		//! \brief Returns the fraction of sites of the specified type that are in domains connected to the electrode for that site type.
+		//! \details Type 1 sites are connected to the z=0 surface, and type 2 sites are connected to the z=Height-1 surface.
+		//! \param site_type specifies for which site type the data should be retrieved, which must be 1 or 2.
+		//! \return -1 if the calculateDomainConnectivity function has not been called.
+		//! \return the volume fraction of the site type that is connected to its electrode.
+		double getConnectedVolumeFraction(const char site_type) const;
 
 		//! \brief Returns a vector containing the pair-pair autocorrelation function data for the specified site type.
 		//! \param site_type specifies for which site type the data should be retrieved.
@@ -198,6 +331,23 @@ namespace Ising_OPV {
 		//! \return the domain anisotropy calculated from the direction dependent correlation function data.
 		double getDomainAnisotropy(const char site_type) const;
 
+		//! \brief Returns the standard error of the domain size determined by the progressive correlation calculation for the specified site type.
+		//! \param site_type specifies for which site type the data should be retrieved.
+		//! \return -1 if the domain size was not determined using the progressive correlation calculation.
+		//! \return the standard error of the domain size estimated from the batch means.
+		double getDomainSizeError(const char site_type) const;
+
+		//! \brief Returns the histogram of the connected domain volumes of the specified site type.
+		//! \details The bin with x value n counts the domains with volumes from 2^n to 2^(n+1)-1 sites, and the bins extend up to the size of the lattice.
+		//! \param site_type specifies for which site type the data should be retrieved.
+		//! \return a vector of x-y pairs consisting of the bin exponents and the number of domains in each bin.
+		std::vector<std::pair<double, int>> getDomainVolumeHistogram(const char site_type) const;
+
+		//! \brief Returns the volumes of the connected domains of the specified site type.
+		//! \param site_type specifies for which site type the data should be retrieved.
+		//! \return a copy of the domain volumes in number of sites, sorted from largest to smallest, which is empty if the calculateDomainConnectivity function has not been called.
+		std::vector<long int> getDomainVolumes(const char site_type) const;
+
 		//! \brief Gets the height or z-direction size of the lattice.
 		//! \return an integer representing the height or z-direction size of the lattice.
 		int getHeight() const;
@@ -222,12 +372,25 @@ namespace Ising_OPV {
 		//! \return an integer representing the length or x-direction size of the lattice.
 		int getLength() const;
 
+		//! \brief Returns the mean chord length for the specified site type and direction in lattice units.
+		//! \param site_type specifies for which site type the data should be retrieved.
+		//! \param direction specifies the direction of the chords, with 1 = x-direction, 2 = y-direction, and 3 = z-direction.
+		//! \return -1 if the calculateChordLengthDistributions function has not been called.
+		//! \return the number-averaged chord length of the specified site type in the specified direction.
+		double getMeanChordLength(const char site_type, const int direction) const;
+
 		//! \brief Returns the mix fraction for the specified site type.
 		//! \param site_type specifies for which site type the data should be retrieved.
 		//! \return -1 if the calculateMixFractions function has not been called.
 		//! \return the volumetric blend ratio of the specified site type.
 		double getMixFraction(const char site_type) const;
 
+		//! \brief Returns the fraction of sites of the specified type that are in domains that touch both the z=0 and z=Height-1 surfaces.
+		//! \param site_type specifies for which site type the data should be retrieved.
+		//! \return -1 if the calculateDomainConnectivity function has not been called.
+		//! \return the volume fraction of the site type in percolating domains.
+		double getPercolatingVolumeFraction(const char site_type) const;
+
 		//! \brief Returns a vector containing the end-to-end tortuosity data for the specified site type.
 		//! \param site_type specifies for which site type the data should be retrieved.
 		//! \return a copy of the data vector.
@@ -241,9 +404,30 @@ namespace Ising_OPV {
 		int getWidth() const;
 
 		//! \brief Imports the tomogram dataset specified in the parameter file.
+		//! \details The tomogram is loaded, interpolated, and analyzed on the first call and kept, so that each later call only creates a new random variant of the mixed phase.
 		//! \returns a vector of Morphology objects that consists of a series of subsections of the original tomogram data.
 		std::vector<Morphology> importTomogramMorphologyFile();
 
+		//! \brief Imports the tomogram dataset specified in the parameter file and passes each extracted morphology to the output function as soon as it is created.
+		//! \details When tiled processing is enabled, the tomogram is streamed from the RAW file in z-bricks that fit in the tile budget, and the segments are assembled in a scratch file,
+		//! so that neither the full tomogram nor the full lattice is held in memory and only one extracted morphology exists at a time.
+		//! Otherwise, the tomogram is processed in memory as by importTomogramMorphologyFile().  Both modes produce the same morphologies.
+		//! \param output_function is the function that is called with each extracted morphology in order.
+		void importTomogramMorphologyFile(const std::function<void(Morphology&)>& output_function);
+
+		//! \brief Imports the morphology from a binary data buffer created by outputMorphologyBuffer.
+		//! \param buffer is the input data buffer.
+		//! \return false if the buffer does not contain a valid morphology.
+		//! \return true if the morphology import is successful.
+		bool importMorphologyBuffer(const std::vector<char>& buffer);
+
+		//! \brief Imports the Ising_OPV binary morphology file created by outputMorphologyBinaryFile.
+		//! \details The file is memory-mapped and the packed site types are unpacked directly from the mapped data in a single pass.
+		//! \param filename is the path of the binary morphology file.
+		//! \return false if the file cannot be opened or does not contain a valid morphology.
+		//! \return true if the morphology import is successful.
+		bool importMorphologyBinaryFile(const std::string& filename);
+
 		//! \brief Imports the Ising_OPV morphology text file given by the specified input filestream.
 		//! \param infile is the already open input filestream pointing to an Ising_OPV morphology file.
 		//! \return false if there is an error during file import.
@@ -263,6 +447,19 @@ namespace Ising_OPV {
 		//! \param outfile is the already open output filestream.
 		void outputDepthDependentData(std::ofstream& outfile) const;
 
+		//! \brief Outputs the morphology data to the specified output filestream in the versioned, bit-packed binary morphology file format.
+		//! \details The file starts with a signature and a fixed header containing the format version, lattice dimensions, periodic boundary options, number of site types,
+		//! and number of bits used per site, followed by the value, domain size, and mix fraction of each site type and the packed site types.
+		//! Each site is packed as the position of its type in the list of site type values.
+		//! Each site uses 1 bit when there are two site types, 2 bits when there are up to four site types, and 8 bits otherwise.
+		//! \param outfile is the already open output filestream, which should be opened in binary mode.
+		void outputMorphologyBinaryFile(std::ofstream& outfile) const;
+
+		//! \brief Outputs the morphology data to a binary data buffer, so that the morphology can be sent to another processor without writing and parsing a morphology file.
+		//! \details The buffer contains the same lattice dimensions, periodic boundary options, domain sizes, and mix fractions as the morphology file, along with the value of each site type, followed by the type of each site.
+		//! \param buffer is the output data buffer, which is resized to fit the morphology data.
+		void outputMorphologyBuffer(std::vector<char>& buffer) const;
+
 		//! \brief Outputs the morphology data to a file specified by the output filestream.
 		//! \details The user can specify whether to use the compressed format or not.
 		//! \param outfile is the already open output filestream.
@@ -278,6 +475,7 @@ namespace Ising_OPV {
 		void outputTortuosityMaps(std::ofstream& outfile) const;
 
 		//! \brief Sets the parameters of the Morphology class using the input Parameters object.
+		//! \details When any of the tomogram import options are changed, the tomogram data loaded by a previous tomogram import is released.
 		//! \param params is the Parameters object that contains all parameters needed by the Morphology class.
 		void setParameters(const Parameters& params);
 
@@ -302,14 +500,25 @@ namespace Ising_OPV {
 		std::vector<std::vector<double>> Correlation_data;
 		std::vector<std::vector<double>> Tortuosity_data;
 		std::vector<std::vector<std::pair<double, int>>> InterfacialHistogram_data;
+		std::vector<std::array<std::vector<std::pair<double, int>>, 3>> ChordLengthHistogram_data;
+		std::vector<std::array<double, 3>> Mean_chord_lengths;
 		std::vector<std::vector<double>> Depth_composition_data;
 		std::vector<std::vector<double>> Depth_domain_size_data;
 		std::vector<double> Depth_iv_data;
 		std::vector<bool> Domain_anisotropy_updated;
 		std::vector<double> Domain_sizes;
+		std::vector<double> Domain_size_errors;
+		std::vector<int> Correlation_site_counts;
 		std::vector<double> Domain_anisotropies;
-		std::vector<int> Island_volume;
+		std::vector<long int> Island_volume;
+		std::vector<std::vector<long int>> Domain_volumes;
+		std::vector<long int> Connected_volumes;
+		std::vector<long int> Percolating_volumes;
 		std::vector<long int> Interfacial_sites;
+		// The interfacial distance field is cached along with the lattice modification count at the time it was calculated
+		mutable std::vector<int> Interfacial_distances_sq;
+		mutable unsigned long Interfacial_distances_modification_count = 0;
+		std::shared_ptr<const TomogramData> Tomogram_data;
 		std::vector<NeighborCounts> Neighbor_counts;
 		std::vector<NeighborInfo> Neighbor_info;
 		NeighborCounts Temp_counts1;
@@ -317,6 +526,11 @@ namespace Ising_OPV {
 		std::mt19937_64 gen = std::mt19937_64((int)time(0));
 
 		// Functions
+		//  This function offers the site with the specified index to the reservoir sample.
+		//  Once the reservoir is full, the random number generator is only called to choose the stream position of the next accepted site,
+		//  so the cost of filling the reservoir from a stream of N sites is O(N_max*(1+log(N/N_max))) random numbers and O(N_max) memory.
+		void addReservoirSite(SiteReservoir& reservoir, const long int site_index);
+
 		void addSiteType(const char site_type);
 
 		//  This function calculates the additional change in energy of the system that would occur if the adjacent sites at (x1,y1,z1) and (x2,y2,z2) were to be swapped with
@@ -326,6 +540,16 @@ namespace Ising_OPV {
 		//  The values for growth_direction are 1 for x-direction, 2 for y-direction, and 3 for z-direction adjustment.
 		double calculateAdditionalEnergyChange(const long int site_index_main, const long int site_index_neighbor, const int growth_direction, const double additional_interaction) const;
 
+		//  This function finds the brightness thresholds below which the N_lower dimmest sites of the tomogram lie for each of the input N_lower values, using two counting passes over the z-bricks.
+		//  The first pass counts the upper 16 bits of the brightness keys to find the bin containing each threshold, and the second pass counts the lower 16 bits of the keys in those bins.
+		//  Sites with equal brightness are ordered as they are classified by classifyTomogramBrick, so each threshold is given by the threshold key and the number of sites with that key that are below the threshold.
+		void calculateBrightnessThresholds(const std::vector<long int>& N_lower, MappedFile& data_file, std::vector<float>& brick, TomogramData& tomogram_data) const;
+
+		//  This function classifies the sites of the z-brick from z_start to z_end in order of increasing z, x, and y position using the brightness thresholds of the tomogram data,
+		//  and calls site_function with the x, y, and z position and the site type of each site, where dark sites are type2, bright sites are type1, and mixed phase sites are given a type of zero.
+		//  The tie counts are the numbers of sites with each threshold key classified so far, so that the classification continues across consecutive bricks.
+		void classifyTomogramBrick(const TomogramData& tomogram_data, const std::vector<float>& brick, const int z_start, const int z_end, std::vector<long int>& tie_counts, const std::function<void(const int, const int, const int, const char)>& site_function) const;
+
 		//  This function calculates the anisotropy of the domains based on the directionally-dependent pair-pair correlation functions
 		//  The correlation function is calculated from each starting site out to the cutoff distance.
 		//  The correlation length in each direction is defined as the distance at which the pair-pair correlation function first crosses the value equal to the mixing fraction
@@ -333,7 +557,13 @@ namespace Ising_OPV {
 		//  For large lattices, the correlation function does not need to be calculated starting from every site to collect enough statistics and instead a sampling of starting sites can be used.
 		//  When the total number of sites is greater than N_sampling_max, N_sampling_max sites are randomly selected and saved for performing a correlation function calculation by sampling.
 		//  When the total number of sites is less than N_sampling_max, all sites will be used as starting points for the correlation function calculation.
-		bool calculateAnisotropy(const std::vector<long int>& correlation_sites, const char site_type, const int cutoff_distance);
+		//  The partial correlation sums are stored in the input anisotropy_data, so that when the function is re-called with a larger cutoff_distance, only the distances beyond the previous cutoff are calculated.
+		bool calculateAnisotropy(const std::vector<long int>& correlation_sites, const char site_type, const int cutoff_distance, AnisotropyData& anisotropy_data);
+
+		//  This function calculates the shortest path distance from each site through sites of the same type to the interface using the 26-neighbor chamfer distances of 1, sqrt(2), and sqrt(3).
+		//  The interfacial sites are seeded with the distance to their nearest neighbor of a different type, and the distances then propagate outward one distance band of one lattice unit at a time.
+		//  Each band is calculated only from the sites finalized in the previous two bands, which are split among the threads, and the candidate distances are collected in per-thread buffers.
+		void calculateChamferInterfacialDistances(std::vector<float>& path_distances) const;
 
 		//  This function calculates the domain size of the morphology based on the pair-pair correlation function
 		//  The correlation function is calculated from each starting site out to the cutoff distance.
@@ -346,10 +576,18 @@ namespace Ising_OPV {
 		//  If the function returns false and the function is re-called with a larger cutoff_distance, the correlation function is not recalculated for close distances and only fills in the missing data for larger distances.
 		double calculateCorrelationDistance(const std::vector<long int>& correlation_sites, std::vector<double>& correlation_data, const double mix_fraction, const int cutoff_distance);
 
-		//  This function calculates the fraction of nearby sites the site at (x,y,z) that are not the same type.
-		//  The radius that determines which sites are included as nearby sites is determined by the rescale factor parameter.
-		//  This function is designed to be used by the executeSmoothing function and implement rescale factor dependent smoothing.
-		double calculateDissimilarFraction(const Coords& coords, const int rescale_factor) const;
+		//  This function determines the domain size from normalized pair-pair correlation function data using the mix fraction method or the 1/e method.
+		//  The function returns -1 if the domain size cannot be determined within the range of the data.
+		double calculateDomainSize(const std::vector<double>& correlation_data) const;
+
+		//  This function calculates the domain size of the specified site type from batches of random starting sites, drawing each batch only when it is needed.
+		//  After each batch, the correlation data of all batches are pooled to update the domain size, and its standard error is estimated with the jackknife method
+		//  from the domain sizes of the pooled data with each batch left out in turn, so that the error matches the pooled estimate.
+		//  The calculation stops once the relative standard error drops below Correlation_tolerance or N_sampling_max sites have been used.
+		//  If a batch requires a larger cutoff_distance, the cutoff is increased and the previous batches are extended to the new cutoff.
+		//  The function returns false if the domain size cannot be determined before the cutoff distance becomes too large for the lattice.
+		bool calculateProgressiveCorrelationDistance(const int type_index, const int cutoff_distance);
+
 
 		//  This function calculates the change in energy of the system that would occur if the adjacent sites at (x1,y1,z1) and (x2,y2,z2) were to be swapped
 		//  Sites must be adjacent to each other for calculation to be correct. (Works for adjacent sites across periodic boundaries)
@@ -366,13 +604,64 @@ namespace Ising_OPV {
 		//  This function calculates the shortest pathways through the domains in the morphology using Dijkstra's algorithm.
 		//  For all type 1 sites, the shortest distance from each site along a path through other type 1 sites to the boundary at z=0 is calculated.
 		//  For all type 2 sites, the shortest distance from each site along a path through other type 2 sites to the boundary at z=Height-1 is calculated.
-		bool calculatePathDistances(std::vector<float>& path_distances);
+		//  The nodes neighboring the finalized nodes are kept in an indexed 4-ary heap, so that distance estimates are updated in place without any per-node allocations.
+		//  The neighbors of each node are generated on the fly from Neighbor_stencil, so the only per-site data are the site types, path distances, and heap positions.
+		//  The pathfinding is only performed for the site types that are enabled in the calc_types vector.
+		bool calculatePathDistances(std::vector<float>& path_distances, const std::vector<bool>& calc_types);
 
 		//  This function calculates the shortest pathways through the domains in the morphology using Dijkstra's algorithm.
 		//  For all type 1 sites, the shortest distance from each site along a path through other type 1 sites to the boundary at z=0 is calculated.
 		//  For all type 2 sites, the shortest distance from each site along a path through other type 2 sites to the boundary at z=Height-1 is calculated.
 		//  As opposed to the calculatePathDistances function, this function uses less memory at the expense of more calculation time.
-		bool calculatePathDistances_ReducedMemory(std::vector<float>& path_distances);
+		//  No per-site data other than the path distances is allocated, and the nodes neighboring the finalized nodes are kept in a binary heap that only grows with the size of the pathfinding front.
+		bool calculatePathDistances_ReducedMemory(std::vector<float>& path_distances, const std::vector<bool>& calc_types);
+
+		//  This function calculates the same shortest pathways as the calculatePathDistances_ReducedMemory function, but the path distance data is stored in a memory-mapped scratch file.
+		//  The data is arranged in z-planes, and the planes that are farther than one plane away from the pathfinding front are periodically written back to the file and released from memory.
+		//  Only the path distances of the top and bottom surfaces are returned in the top_distances and bottom_distances vectors, which are indexed by Width*x+y.
+		//  The island volume of both site types is also calculated.
+		bool calculatePathDistances_OutOfCore(std::vector<float>& top_distances, std::vector<float>& bottom_distances);
+
+		//  This function calculates the end-to-end tortuosity data and the island volume of the site types that are enabled in the calc_types vector.
+		//  The pathfinding is only performed for the enabled site types, and the data of the other site types is left unchanged.
+		//  The out-of-core implementation always calculates the path distances of both site types.
+		bool calculateTortuosityData(const std::vector<bool>& calc_types, const bool enable_reduced_memory, const bool enable_out_of_core);
+
+		//  This function calculates the one-dimensional squared Euclidean distance transform of the input line in place using the lower envelope of parabolas (Felzenszwalb and Huttenlocher).
+		//  Each input value is the squared distance already accumulated at that position, with Infinite_distance_sq marking positions without a known distance.
+		//  The line is split into runs of sites with the same type in line_types, and each run is transformed separately with the sites of a different type at its ends as features at zero distance.
+		//  Periodic lines without any change in site type are extended by up to half of their length on each side, so that the nearest periodic image of each position is included.
+		void calculateDistanceTransform1D(std::vector<int>& line, const std::vector<char>& line_types, const bool is_periodic, DistanceTransformData& data) const;
+
+		//  This function labels the connected domains of all site types and calculates the volume, site type, and surface contacts of each domain.
+		//  Sites are connected to same type neighbors with squared distances up to max_distance_sq, and domains can cross the periodic x and y boundaries, but not the z boundaries.
+		std::vector<DomainData> calculateDomainData(const int max_distance_sq) const;
+
+		//  This function creates the extracted morphologies from the tomogram data for tiled processing and passes each of them to the output function.
+		//  The z-bricks are classified in a single pass over the RAW file, and the site types of each segment are written to a scratch file with the z index changing slowest,
+		//  so that the part of the scratch file written for each brick can be released, and each segment is then reordered into its lattice as it is output.
+		void importTomogramSegments_Tiled(const int dim, const int segment_length, const int segment_width, const int offset_x, const int offset_y, const std::function<void(Morphology&)>& output_function);
+
+		//  This function parses the xml metadata file and maps the RAW data file of the tomogram, determines the final lattice dimensions and the z-brick height,
+		//  and finds the brightness thresholds from the data interpolated onto the lattice with the desired unit size.
+		//  Unless tiled processing is enabled, the pure phase sites are also assigned, storing the result and the indices of the mixed phase sites in the input tomogram data.
+		void loadTomogramData(TomogramData& tomogram_data);
+
+		//  This function calculates the exact squared Euclidean distance from each site to the nearest site of a different type using a separable distance transform.
+		//  The transform is applied to lines along the z-, y-, and x-directions in turn, with the lines of each pass calculated in parallel.
+		//  The sites of all types are transformed together, because the sites of the other types only enter the transform of each run of same type sites as its end points.
+		//  Sites with no site of a different type in the lattice are assigned a distance of Infinite_distance_sq.
+		void calculateInterfacialDistanceField(std::vector<int>& distances_sq) const;
+
+		//  This function calculates the number of type 1 and type 2 sites in the spherical smoothing neighborhood of each site, not including the site itself.
+		//  The neighborhood includes the offsets with squared distances up to cutoff_squared and is split into z-line segments, one for each x-y offset,
+		//  so that the count for each segment is given by the difference of two prefix sums along the neighboring z-line.
+		void calculateNeighborTypeCounts(const std::vector<char>& site_types, const int radius, const int cutoff_squared, std::vector<unsigned short>& type1_counts, std::vector<unsigned short>& type2_counts) const;
+
+		//  This function calculates the coordinates of the neighbor of the site at (x,y,z) given by the specified stencil offset.
+		//  Paths can cross the periodic x and y boundaries, but not the z boundaries.
+		//  Returns false if the neighbor is outside of the lattice.
+		bool calculatePathNeighborCoords(const int x, const int y, const int z, const NeighborOffset& offset, Coords& coords_dest) const;
 
 		// This function writes the node data for the site at the given x, y, z coordinates to the specified input node variable.
 		// Each node contains a vector with indices of all first- ,second-, and third-nearest neighbors (at most 26 neighbors).
@@ -380,9 +669,28 @@ namespace Ising_OPV {
 		// Each node also has an estimated distance from the destination and the corresponding site index.
 		void createNode(Node& node, const Coords& coords);
 
+		//  This function returns an unsigned integer key with the same ordering as the input brightness value, so that brightness values can be counted in histograms of the key bits.
+		unsigned int getBrightnessKey(const float brightness) const;
+
+		//  This function returns the squared distance from each site to the nearest site of a different type.
+		//  The distance field is calculated by calculateInterfacialDistanceField when first needed and is kept until the lattice modification count changes.
+		const std::vector<int>& getInterfacialDistanceField() const;
+
+		//  This function randomly assigns the next of the remaining mixed phase sites as type1 or type2 using selection sampling,
+		//  so that exactly N_type1_remaining of the N_mixed_remaining sites are assigned as type1 when all of the sites are assigned in order.
+		char getMixedSiteType(long int& N_mixed_remaining, long int& N_type1_remaining);
+
+		//  This function randomly selects N_sites sites of the specified type that are not already in selected_sites by drawing random lattice sites until enough are found.
+		//  The selected sites are added to selected_sites, so that repeated calls draw new sites without replacement.
+		//  This is only efficient when a small fraction of the sites of the type are selected in total.
+		void getRandomSites(std::vector<long int>& sites, const char site_type, const int N_sites, std::unordered_set<long int>& selected_sites);
+
+		//  This function randomly selects at most N_sites sites of the specified type using a single pass of reservoir sampling over the lattice.
+		//  The selected site indices are shuffled, so that the output order is random and reproducible for a given random number generator seed.
 		void getSiteSampling(std::vector<long int>& sites, const char site_type, const int N_sites);
 
-		void getSiteSamplingZ(std::vector<long int>& sites, const char site_type, const int N_sites, const int z);
+		//  This function initializes the reservoir sample so that it can hold at most N_max site indices.
+		void initializeReservoir(SiteReservoir& reservoir, const long int N_max);
 
 		int getSiteTypeIndex(const char site_type) const;
 
@@ -391,9 +699,27 @@ namespace Ising_OPV {
 		//  number of similar type first, second and third nearest-neighbors.
 		void initializeNeighborInfo();
 
-		//  This function determines whether the site at (x,y,z) is within the specified distance from the interface.
-		//  If so, the function returns true and if not, the function returns false.
-		bool isNearInterface(const Coords& coords, const double distance) const;
+		//  This function calculates the resampling table of one axis that maps the N_out output positions with unit size unit_size onto the N_in input positions with unit size unit_size_i.
+		//  Linear interpolation uses two taps and cubic interpolation uses four Catmull-Rom taps, with the input indices clamped at the ends of the axis.
+		void calculateResamplingTable(const int N_out, const double unit_size, const int N_in, const double unit_size_i, const int order, ResamplingTable& table) const;
+
+		//  This function interpolates the tomogram data onto the lattice in z-bricks of at most brick_height planes and calls brick_function with the z range of each brick in order of increasing z.
+		//  Each brick is stored in the input brick vector with the z index changing fastest, and the pages of the RAW file below the next brick are released after each brick.
+		//  When a single brick holds all of the planes and has already been interpolated, it is reused.
+		void processTomogramBricks(const TomogramData& tomogram_data, MappedFile& data_file, std::vector<float>& brick, const std::function<void(const int, const int)>& brick_function) const;
+
+		//  This function interpolates the tomogram data, which is kept in its native 8 bit or 16 bit voxel type, onto the z-planes from z_start to z_end of the final lattice.
+		//  The data is read directly in the RAW file layout given by the initial lattice parameters, where the x index changes fastest, without first reorienting it into a separate array.
+		//  With an interpolation order of zero, inverse distance weighting of the eight surrounding voxels is used with the per-axis distances precomputed.
+		//  Otherwise, the separable trilinear or tricubic kernel is applied one axis at a time to each x-slab of the lattice using the per-axis resampling tables.
+		//  The x-slabs are interpolated in parallel, and each value is calculated in a fixed order, so the result does not depend on the number of threads.
+		template<typename T>
+		void interpolateTomogramData(const T* data, const Lattice::Lattice_Params& params_initial, const Lattice::Lattice_Params& params_final, const int interpolation_order, const int z_start, const int z_end, std::vector<float>& data_final) const;
+
+		//  This function labels the connected domains of all site types using a union-find algorithm and returns the number of domains.
+		//  The lattice is split into slabs along the x-direction that are labeled in parallel, and the domains are then merged across the slab boundaries.
+		//  Each domain label is the rank of the lowest site index in the domain, so the labels do not depend on the number of threads.
+		long int labelDomains(std::vector<long int>& labels, const int max_distance_sq) const;
 
 		double rand01();
 
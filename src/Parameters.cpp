@@ -71,10 +71,24 @@ namespace Ising_OPV {
 			cout << "Parameter error! When performing the correlation calculation, either the mix fraction method or the 1/e method must be enabled." << endl;
 			Error_found = true;
 		}
+		if (Enable_correlation_calc && Enable_progressive_correlation_calc && !(Correlation_tolerance > 0)) {
+			cout << "Parameter error! When performing the progressive correlation calculation, Correlation_tolerance must be greater than zero." << endl;
+			Error_found = true;
+		}
 		if (Enable_correlation_calc && Enable_extended_correlation_calc && !(Extended_correlation_cutoff_distance > 0)) {
 			cout << "Parameter error! When performing the extended correlation calculation, Extended_correlation_cutoff_distance must be greater than zero." << endl;
 			Error_found = true;
 		}
+		// Check the tortuosity calculation parameters
+		if (Enable_tortuosity_calc && Enable_reduced_memory_tortuosity_calc && Enable_out_of_core_tortuosity_calc) {
+			cout << "Parameter error! When performing the tortuosity calculation, the reduced memory and out-of-core methods cannot both be enabled." << endl;
+			Error_found = true;
+		}
+		// Check the domain connectivity calculation parameters
+		if (Enable_connectivity_calc && N_connectivity_neighbors != 6 && N_connectivity_neighbors != 18 && N_connectivity_neighbors != 26) {
+			cout << "Parameter error! When performing the domain connectivity calculation, the input N_connectivity_neighbors must be 6, 18, or 26." << endl;
+			Error_found = true;
+		}
 		// Check the growth preference parameters
 		if (Enable_growth_pref && (Growth_direction < 1 || Growth_direction > 3)) {
 			cout << "Parameter error! When performing phase separation with a directional growth preference, the input Growth_direction paramter must be 1, 2, or 3." << endl;
@@ -93,6 +107,14 @@ namespace Ising_OPV {
 			cout << "Parameter error! When importing a tomogram dataset, the input Desired_unit_size must not be zero." << endl;
 			Error_found = true;
 		}
+		if (Enable_import_tomogram && Tomogram_interpolation_order != 0 && Tomogram_interpolation_order != 1 && Tomogram_interpolation_order != 3) {
+			cout << "Parameter error! When importing a tomogram dataset, the input Tomogram_interpolation_order must be 0, 1, or 3." << endl;
+			Error_found = true;
+		}
+		if (Enable_import_tomogram && Enable_tiled_tomogram_import && Tomogram_tile_budget <= 0) {
+			cout << "Parameter error! When importing a tomogram dataset in tiles, the input Tomogram_tile_budget must be greater than zero." << endl;
+			Error_found = true;
+		}
 		if (Enable_import_tomogram && !(Mixed_frac < 1)) {
 			cout << "Parameter error! When importing a tomogram dataset, the Mixed_frac must be graeter than equal to 0 and less than 1." << endl;
 			Error_found = true;
@@ -168,7 +190,7 @@ namespace Ising_OPV {
 			}
 		}
 		// Check that correct number of parameters have been imported
-		if ((int)stringvars.size() != 42) {
+		if ((int)stringvars.size() != 54) {
 			cout << "Error! Incorrect number of parameters were loaded from the parameter file." << endl;
 			return false;
 		}
@@ -212,6 +234,16 @@ namespace Ising_OPV {
 		i++;
 		Smoothing_threshold = atof(stringvars[i].c_str());
 		i++;
+		//enable_parallel_smoothing
+		try {
+			Enable_parallel_smoothing = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting morphology smoothing options" << endl;
+			Error_found = true;
+		}
+		i++;
 		//enable_rescale
 		try {
 			Enable_rescale = str2bool(stringvars[i]);
@@ -269,6 +301,18 @@ namespace Ising_OPV {
 		i++;
 		N_sampling_max = atoi(stringvars[i].c_str());
 		i++;
+		//enable_progressive_correlation_calc
+		try {
+			Enable_progressive_correlation_calc = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting progressive correlation calculation options" << endl;
+			Error_found = true;
+		}
+		i++;
+		Correlation_tolerance = atof(stringvars[i].c_str());
+		i++;
 		//enable_mix_frac_method
 		try {
 			Enable_mix_frac_method = str2bool(stringvars[i]);
@@ -311,6 +355,26 @@ namespace Ising_OPV {
 			Error_found = true;
 		}
 		i++;
+		//enable_chamfer_interfacial_distance_calc
+		try {
+			Enable_chamfer_interfacial_distance_calc = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting chamfer interfacial distance calculation options" << endl;
+			Error_found = true;
+		}
+		i++;
+		//enable_chord_length_calc
+		try {
+			Enable_chord_length_calc = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting chord length calculation options" << endl;
+			Error_found = true;
+		}
+		i++;
 		//enable_tortuosity_calc
 		try {
 			Enable_tortuosity_calc = str2bool(stringvars[i]);
@@ -331,6 +395,28 @@ namespace Ising_OPV {
 			Error_found = true;
 		}
 		i++;
+		//enable_out_of_core_tortuosity_calc
+		try {
+			Enable_out_of_core_tortuosity_calc = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting out-of-core tortuosity calculation options" << endl;
+			Error_found = true;
+		}
+		i++;
+		//enable_connectivity_calc
+		try {
+			Enable_connectivity_calc = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting domain connectivity calculation options" << endl;
+			Error_found = true;
+		}
+		i++;
+		N_connectivity_neighbors = atoi(stringvars[i].c_str());
+		i++;
 		//enable_depth_dependent_cal
 		try {
 			Enable_depth_dependent_calc = str2bool(stringvars[i]);
@@ -386,6 +472,16 @@ namespace Ising_OPV {
 			Error_found = true;
 		}
 		i++;
+		//Enable_export_binary_files
+		try {
+			Enable_export_binary_files = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting export options" << endl;
+			Error_found = true;
+		}
+		i++;
 		//Enable_export_cross_section
 		try {
 			Enable_export_cross_section = str2bool(stringvars[i]);
@@ -422,6 +518,19 @@ namespace Ising_OPV {
 		i++;
 		Desired_unit_size = atof(stringvars[i].c_str());
 		i++;
+		Tomogram_interpolation_order = atoi(stringvars[i].c_str());
+		i++;
+		try {
+			Enable_tiled_tomogram_import = str2bool(stringvars[i]);
+		}
+		catch (invalid_argument& exception) {
+			cout << exception.what() << endl;
+			cout << "Error setting tiled tomogram import option" << endl;
+			Error_found = true;
+		}
+		i++;
+		Tomogram_tile_budget = atoi(stringvars[i].c_str());
+		i++;
 		//try {
 		//	Enable_cutoff_analysis = str2bool(stringvars[i]);
 		//}
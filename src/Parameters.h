@@ -57,6 +57,8 @@ namespace Ising_OPV {
 		bool Enable_smoothing = false;
 		//! cutoff threshold for the smoothing algorithm
 		double Smoothing_threshold = 0.0;
+		//! choose whether or not to perform the smoothing in parallel using a block decomposition of the lattice
+		bool Enable_parallel_smoothing = false;
 		 // Rescale Options
 		 //! choose whether or nmot to perform lattice rescaling
 		bool Enable_rescale = false; 
@@ -78,6 +80,10 @@ namespace Ising_OPV {
 		bool Enable_correlation_calc = false; 
 		//! maximum number of sites to be sampled for calculating the autocorrelation function
 		int N_sampling_max = 0;
+		//! choose whether or not to sample the autocorrelation function in batches of sites and stop once the domain size has converged
+		bool Enable_progressive_correlation_calc = false;
+		//! target relative standard error of the domain size for the progressive autocorrelation calculation
+		double Correlation_tolerance = 0;
 		//! choose whether or not to use the mix fraction method for determining the domain size from the autocorrelation data
 		bool Enable_mix_frac_method = false;
 		//! choose whether or not to use the 1/e method for determining the domain size from the autocorrelation data
@@ -88,10 +94,20 @@ namespace Ising_OPV {
 		int Extended_correlation_cutoff_distance = 0;
 		//! choose whether or not to calculate the interfacial distance histograms
 		bool Enable_interfacial_distance_calc = false;
+		//! choose whether the interfacial distances are calculated as 26-neighbor chamfer path distances through same type sites instead of exact Euclidean distances
+		bool Enable_chamfer_interfacial_distance_calc = false;
+		//! choose whether or not to calculate the chord length histograms and mean chord lengths in each direction
+		bool Enable_chord_length_calc = false;
 		//! choose whether or not to calculate the end-to-end tortuosity histograms and island volume fraction
 		bool Enable_tortuosity_calc = false;
 		//! choose whether or not to perform the tortuosity calculation using an algorithm that takes longer, but uses less memory
 		bool Enable_reduced_memory_tortuosity_calc = false;
+		//! choose whether or not to perform the tortuosity calculation using an algorithm that stores the path distance data in a scratch file to limit the memory usage
+		bool Enable_out_of_core_tortuosity_calc = false;
+		//! choose whether or not to label the connected domains and calculate the domain volume distributions, electrode connectivity, and percolation of each site type
+		bool Enable_connectivity_calc = false;
+		//! specify the number of neighbors that each site can be connected to in the domain connectivity calculation (6, 18, or 26)
+		int N_connectivity_neighbors = 26;
 		//! choose whether or not to calculate and output the film depth dependent morphology characteristics
 		bool Enable_depth_dependent_calc = false;
 		//! choose whether or not to calculate and output areal mappings of the morphology characteristics
@@ -108,6 +124,8 @@ namespace Ising_OPV {
 		// Export Morphology Options
 		//! choose whether or not the output morphology data file is in compressed format
 		bool Enable_export_compressed_files = true;
+		//! choose whether or not the output morphology data file is in the bit-packed binary format instead of a text format
+		bool Enable_export_binary_files = false;
 		//! choose whether or not to output uncompressed data for a cross-section (x=Length/2 plane) of the morphology
 		bool Enable_export_cross_section = false;
 		// Import Morphology Options
@@ -119,6 +137,12 @@ namespace Ising_OPV {
 		std::string Tomogram_name = "";
 		//! desired unit size (resolution) of the output morphology dataset extracted from the tomogram
 		double Desired_unit_size = 0.0;
+		//! interpolation method used to convert the tomogram dataset to the desired unit size, where 0 is inverse distance weighting, 1 is trilinear, and 3 is tricubic interpolation
+		int Tomogram_interpolation_order = 0;
+		//! choose whether or not to process the tomogram dataset in z-bricks, so that datasets that do not fit in memory can be imported
+		bool Enable_tiled_tomogram_import = false;
+		//! approximate memory budget in megabytes for each z-brick of the tomogram dataset when tiled processing is enabled
+		int Tomogram_tile_budget = 0;
 		//! volume fraction of the mixed phase in the tomogram dataset
 		double Mixed_frac = 0.0;
 		//! volume fraction of type1 sites in the mixed phase of the tomogram dataset
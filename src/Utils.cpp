@@ -4,6 +4,11 @@
 // The Ising_OPV project can be found on Github at https://github.com/MikeHeiber/Ising_OPV
 
 #include "Utils.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -504,6 +509,60 @@ namespace Ising_OPV {
 		return output_vector;
 	}
 
+	std::vector<char> MPI_receiveBuffer(const int source) {
+		// Receive the total size of the incoming buffer
+		long int buffer_size;
+		MPI_Recv(&buffer_size, 1, MPI_LONG, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		// The buffer is received in chunks, and the size of each chunk is determined before it is received
+		vector<char> buffer(buffer_size);
+		long int position = 0;
+		while (position < buffer_size) {
+			MPI_Status status;
+			MPI_Probe(source, 0, MPI_COMM_WORLD, &status);
+			int chunk_size;
+			MPI_Get_count(&status, MPI_CHAR, &chunk_size);
+			MPI_Recv(buffer.data() + position, chunk_size, MPI_CHAR, source, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+			position += chunk_size;
+		}
+		return buffer;
+	}
+
+	void MPI_sendBuffer(const std::vector<char>& buffer, const int destination, const int max_chunk_size) {
+		if (max_chunk_size <= 0) {
+			throw invalid_argument("The maximum chunk size must be positive.");
+		}
+		// The total size is sent first, and then the buffer is sent in chunks that each fit in a single int count
+		long int buffer_size = (long int)buffer.size();
+		MPI_Send(&buffer_size, 1, MPI_LONG, destination, 0, MPI_COMM_WORLD);
+		for (long int position = 0; position < buffer_size; position += max_chunk_size) {
+			int chunk_size = (int)min((long int)max_chunk_size, buffer_size - position);
+			MPI_Send(buffer.data() + position, chunk_size, MPI_CHAR, destination, 0, MPI_COMM_WORLD);
+		}
+	}
+
+	bool parseInteger(const char*& pos, const char* end, long int& value) {
+		const char* ptr = pos;
+		while (ptr != end && (*ptr == ' ' || *ptr == '\t')) {
+			ptr++;
+		}
+		bool is_negative = false;
+		if (ptr != end && (*ptr == '-' || *ptr == '+')) {
+			is_negative = (*ptr == '-');
+			ptr++;
+		}
+		if (ptr == end || *ptr < '0' || *ptr > '9') {
+			return false;
+		}
+		long int result = 0;
+		while (ptr != end && *ptr >= '0' && *ptr <= '9') {
+			result = 10 * result + (*ptr - '0');
+			ptr++;
+		}
+		value = is_negative ? -result : result;
+		pos = ptr;
+		return true;
+	}
+
 	std::string removeWhitespace(const std::string& str_input) {
 		// Remove tab characters
 		string str_out = str_input;
@@ -528,4 +587,280 @@ namespace Ising_OPV {
 			throw invalid_argument("Error! Input string is not true or false.");
 		}
 	}
+
+	IndexedMinHeap::IndexedMinHeap(const long int N_items) {
+		Positions.assign(N_items, -1);
+	}
+
+	void IndexedMinHeap::clear() {
+		for (const auto& item : Items) {
+			Positions[item.index] = -1;
+		}
+		Items.clear();
+	}
+
+	bool IndexedMinHeap::contains(const long int index) const {
+		return Positions[index] >= 0;
+	}
+
+	bool IndexedMinHeap::empty() const {
+		return Items.empty();
+	}
+
+	float IndexedMinHeap::getKey(const long int index) const {
+		return Items[Positions[index]].key;
+	}
+
+	long int IndexedMinHeap::getTopIndex() const {
+		return Items[0].index;
+	}
+
+	float IndexedMinHeap::getTopKey() const {
+		return Items[0].key;
+	}
+
+	void IndexedMinHeap::pop() {
+		Positions[Items[0].index] = -1;
+		if (Items.size() > 1) {
+			Items[0] = Items.back();
+			Positions[Items[0].index] = 0;
+			Items.pop_back();
+			siftDown(0);
+		}
+		else {
+			Items.pop_back();
+		}
+	}
+
+	bool IndexedMinHeap::push(const long int index, const float key) {
+		int position = Positions[index];
+		if (position < 0) {
+			Items.push_back({ key, index });
+			position = (int)Items.size() - 1;
+			Positions[index] = position;
+		}
+		else if (key < Items[position].key) {
+			Items[position].key = key;
+		}
+		else {
+			return false;
+		}
+		siftUp(position);
+		return true;
+	}
+
+	long int IndexedMinHeap::size() const {
+		return (long int)Items.size();
+	}
+
+	void IndexedMinHeap::siftDown(int position) {
+		HeapItem item = Items[position];
+		int N_items = (int)Items.size();
+		while (true) {
+			// Find the smallest of the up to four children
+			int child = 4 * position + 1;
+			if (child >= N_items) {
+				break;
+			}
+			int child_end = (child + 4 < N_items) ? child + 4 : N_items;
+			int smallest = child;
+			for (int i = child + 1; i < child_end; i++) {
+				if (Items[i] < Items[smallest]) {
+					smallest = i;
+				}
+			}
+			if (!(Items[smallest] < item)) {
+				break;
+			}
+			Items[position] = Items[smallest];
+			Positions[Items[position].index] = position;
+			position = smallest;
+		}
+		Items[position] = item;
+		Positions[item.index] = position;
+	}
+
+	void IndexedMinHeap::siftUp(int position) {
+		HeapItem item = Items[position];
+		while (position > 0) {
+			int parent = (position - 1) / 4;
+			if (!(item < Items[parent])) {
+				break;
+			}
+			Items[position] = Items[parent];
+			Positions[Items[position].index] = position;
+			position = parent;
+		}
+		Items[position] = item;
+		Positions[item.index] = position;
+	}
+
+	MappedFile::~MappedFile() {
+		close();
+	}
+
+	void MappedFile::close() {
+		if (Data != nullptr) {
+			munmap(Data, Size);
+			Data = nullptr;
+		}
+		if (File_descriptor >= 0) {
+			::close(File_descriptor);
+			File_descriptor = -1;
+		}
+		Size = 0;
+	}
+
+	const char* MappedFile::data() const {
+		return Data;
+	}
+
+	bool MappedFile::open(const string& filename) {
+		close();
+		File_descriptor = ::open(filename.c_str(), O_RDONLY);
+		if (File_descriptor < 0) {
+			return false;
+		}
+		struct stat file_stats;
+		if (fstat(File_descriptor, &file_stats) != 0) {
+			close();
+			return false;
+		}
+		Size = (size_t)file_stats.st_size;
+		// Empty files cannot be mapped, but are still opened successfully.
+		if (Size == 0) {
+			return true;
+		}
+		void* ptr = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, File_descriptor, 0);
+		if (ptr == MAP_FAILED) {
+			Size = 0;
+			close();
+			return false;
+		}
+		Data = (char*)ptr;
+		return true;
+	}
+
+	void MappedFile::release(const size_t offset, const size_t length) {
+		if (Data == nullptr || offset >= Size) {
+			return;
+		}
+		size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+		size_t start = ((offset + page_size - 1) / page_size)*page_size;
+		size_t end = ((std::min(offset + length, Size)) / page_size)*page_size;
+		if (end <= start) {
+			return;
+		}
+		// The pages are never modified, so they can be dropped from the process and from the page cache without writing them back.
+		madvise(Data + start, end - start, MADV_DONTNEED);
+		posix_fadvise(File_descriptor, (off_t)start, (off_t)(end - start), POSIX_FADV_DONTNEED);
+	}
+
+	size_t MappedFile::size() const {
+		return Size;
+	}
+
+	ScratchFile::~ScratchFile() {
+		close();
+	}
+
+	void ScratchFile::close() {
+		if (Data != nullptr) {
+			munmap(Data, Size);
+			Data = nullptr;
+		}
+		if (File_descriptor >= 0) {
+			::close(File_descriptor);
+			File_descriptor = -1;
+		}
+		Size = 0;
+	}
+
+	char* ScratchFile::data() const {
+		return Data;
+	}
+
+	bool ScratchFile::open(const string& filename, const size_t size) {
+		close();
+		if (size == 0) {
+			cout << "Error! The scratch file size must be greater than zero." << endl;
+			return false;
+		}
+		File_descriptor = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+		if (File_descriptor < 0) {
+			cout << "Error! Scratch file " << filename << " could not be created." << endl;
+			return false;
+		}
+		// The directory entry is removed immediately, so the file only exists as long as it is open.
+		unlink(filename.c_str());
+		if (ftruncate(File_descriptor, (off_t)size) != 0) {
+			cout << "Error! Scratch file " << filename << " could not be resized to " << size << " bytes." << endl;
+			close();
+			return false;
+		}
+		void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, File_descriptor, 0);
+		if (ptr == MAP_FAILED) {
+			cout << "Error! Scratch file " << filename << " could not be memory-mapped." << endl;
+			close();
+			return false;
+		}
+		Data = (char*)ptr;
+		Size = size;
+		return true;
+	}
+
+	void ScratchFile::release(const size_t offset, const size_t length) {
+		if (Data == nullptr || offset >= Size) {
+			return;
+		}
+		size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+		size_t start = ((offset + page_size - 1) / page_size)*page_size;
+		size_t end = ((std::min(offset + length, Size)) / page_size)*page_size;
+		if (end <= start) {
+			return;
+		}
+		// Modified pages are written back to the file before they are dropped from the process and from the page cache.
+		msync(Data + start, end - start, MS_SYNC);
+		madvise(Data + start, end - start, MADV_DONTNEED);
+		posix_fadvise(File_descriptor, (off_t)start, (off_t)(end - start), POSIX_FADV_DONTNEED);
+	}
+
+	size_t ScratchFile::size() const {
+		return Size;
+	}
+
+	TextFileReader::TextFileReader(istream& input, const size_t buffer_size) : Input(input), Buffer(buffer_size > 0 ? buffer_size : 1) {
+	}
+
+	bool TextFileReader::getLine(const char*& line_begin, const char*& line_end) {
+		while (true) {
+			const char* newline = (const char*)memchr(Buffer.data() + Begin, '\n', End - Begin);
+			if (newline != nullptr || (End_of_input && Begin < End)) {
+				line_begin = Buffer.data() + Begin;
+				line_end = (newline != nullptr) ? newline : Buffer.data() + End;
+				Begin = (newline != nullptr) ? (size_t)(newline - Buffer.data()) + 1 : End;
+				if (line_end != line_begin && *(line_end - 1) == '\r') {
+					line_end--;
+				}
+				return true;
+			}
+			if (End_of_input) {
+				return false;
+			}
+			// Move the incomplete line to the start of the buffer, enlarge the buffer if the line fills it, and read the next block of the input stream
+			if (Begin > 0) {
+				memmove(Buffer.data(), Buffer.data() + Begin, End - Begin);
+				End -= Begin;
+				Begin = 0;
+			}
+			if (End == Buffer.size()) {
+				Buffer.resize(2 * Buffer.size());
+			}
+			Input.read(Buffer.data() + End, Buffer.size() - End);
+			End += (size_t)Input.gcount();
+			if (!Input) {
+				End_of_input = true;
+			}
+		}
+	}
 }
@@ -11,6 +11,7 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mpi.h>
 #include <numeric>
@@ -62,6 +63,202 @@ namespace Ising_OPV {
 		}
 	};
 
+	//! \brief This class implements an indexed 4-ary min-heap of items with float keys that supports decrease-key operations.
+	//! \details Items are identified by integer indices from 0 to N_items-1, and the heap position of each item is stored in a flat array,
+	//! so that items can be located and updated in constant time without any per-item allocations.
+	//! Items with equal keys are ordered by their index.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2014-2019
+	class IndexedMinHeap {
+	public:
+		//! \brief Constructs an empty heap that cannot hold any items.
+		IndexedMinHeap() {}
+
+		//! \brief Constructs an empty heap that can hold items with indices from 0 to N_items-1.
+		//! \param N_items is the number of items that can be stored in the heap.
+		explicit IndexedMinHeap(const long int N_items);
+
+		//! \brief Removes all items from the heap.
+		void clear();
+
+		//! \brief Checks whether the specified item is currently in the heap.
+		//! \param index is the index of the item.
+		//! \return true if the item is in the heap.
+		//! \return false if the item is not in the heap.
+		bool contains(const long int index) const;
+
+		//! \brief Checks whether the heap is empty.
+		//! \return true if the heap contains no items.
+		//! \return false if the heap contains at least one item.
+		bool empty() const;
+
+		//! \brief Gets the key of the specified item.
+		//! \param index is the index of the item, which must be in the heap.
+		//! \return the current key of the item.
+		float getKey(const long int index) const;
+
+		//! \brief Gets the index of the item with the smallest key.
+		//! \return the index of the top item, which is undefined when the heap is empty.
+		long int getTopIndex() const;
+
+		//! \brief Gets the smallest key in the heap.
+		//! \return the key of the top item, which is undefined when the heap is empty.
+		float getTopKey() const;
+
+		//! \brief Removes the item with the smallest key from the heap.
+		void pop();
+
+		//! \brief Inserts the specified item with the input key or decreases the key of an item that is already in the heap.
+		//! \param index is the index of the item.
+		//! \param key is the new key of the item.
+		//! \return true if the item was inserted or its key was decreased.
+		//! \return false if the item is already in the heap with a key that is less than or equal to the input key.
+		bool push(const long int index, const float key);
+
+		//! \brief Gets the number of items in the heap.
+		//! \return the number of items in the heap.
+		long int size() const;
+
+	private:
+		struct HeapItem {
+			float key;
+			long int index;
+			bool operator<(const HeapItem& rhs) const {
+				return (key < rhs.key || (key == rhs.key && index < rhs.index));
+			}
+		};
+		std::vector<HeapItem> Items;
+		// Position of each item in the Items vector, which is -1 for items that are not in the heap
+		std::vector<int> Positions;
+
+		void siftDown(int position);
+		void siftUp(int position);
+	};
+
+	//! \brief This class manages a temporary file that is memory-mapped into the address space as a scratch array.
+	//! \details The file is removed from the file system as soon as it is mapped, so that it is automatically deleted when the object is destroyed or the program exits.
+	//! Pages of the file are read from disk when accessed and can be written back and released from memory again using the release function,
+	//! which allows data sets that are larger than the available memory to be processed in pieces.
+	//! The file is initially filled with zeros.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2014-2019
+	class ScratchFile {
+	public:
+		//! \brief Constructs an empty scratch file object that is not associated with any file.
+		ScratchFile() {}
+
+		//! \brief Unmaps and closes the scratch file.
+		~ScratchFile();
+
+		ScratchFile(const ScratchFile&) = delete;
+		ScratchFile& operator=(const ScratchFile&) = delete;
+
+		//! \brief Closes the scratch file and releases all of its data.
+		void close();
+
+		//! \brief Gets a pointer to the start of the mapped data.
+		//! \return a pointer to the data, which is nullptr when no file is open.
+		char* data() const;
+
+		//! \brief Creates and maps a new zero-filled scratch file with the specified size.
+		//! \param filename is the path of the scratch file to be created.
+		//! \param size is the size of the file in bytes.
+		//! \return true if the file was successfully created and mapped.
+		//! \return false if the file could not be created or mapped.
+		bool open(const std::string& filename, const size_t size);
+
+		//! \brief Writes the specified range of the file back to disk and releases it from memory.
+		//! \details Only the whole pages within the range are released. The data in the range can still be accessed afterwards and is read back from the file as needed.
+		//! \param offset is the offset of the start of the range in bytes.
+		//! \param length is the length of the range in bytes.
+		void release(const size_t offset, const size_t length);
+
+		//! \brief Gets the size of the scratch file.
+		//! \return the size of the file in bytes.
+		size_t size() const;
+
+	private:
+		int File_descriptor = -1;
+		char* Data = nullptr;
+		size_t Size = 0;
+	};
+
+	//! \brief This class manages a read-only memory mapping of an existing file.
+	//! \details The file data is read from disk as it is accessed, so large data files can be used without first reading them into memory.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2014-2019
+	class MappedFile {
+	public:
+		//! \brief Constructs an empty mapped file object that is not associated with any file.
+		MappedFile() {}
+
+		//! \brief Unmaps and closes the file.
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//! \brief Unmaps and closes the file.
+		void close();
+
+		//! \brief Gets a pointer to the start of the mapped data.
+		//! \return a pointer to the data, which is nullptr when no file is open or the file is empty.
+		const char* data() const;
+
+		//! \brief Opens and maps the specified existing file for reading.
+		//! \param filename is the path of the file to be mapped.
+		//! \return true if the file was successfully opened and mapped.
+		//! \return false if the file could not be opened or mapped.
+		bool open(const std::string& filename);
+
+		//! \brief Releases the specified range of the file from memory.
+		//! \details Only the whole pages within the range are released. The data in the range can still be accessed afterwards and is read back from the file as needed.
+		//! \param offset is the offset of the start of the range in bytes.
+		//! \param length is the length of the range in bytes.
+		void release(const size_t offset, const size_t length);
+
+		//! \brief Gets the size of the mapped file.
+		//! \return the size of the file in bytes.
+		size_t size() const;
+
+	private:
+		int File_descriptor = -1;
+		char* Data = nullptr;
+		size_t Size = 0;
+	};
+
+	//! \brief This class reads the lines of a text input stream through a large read buffer without allocating memory for each line.
+	//! \details Each line is returned as a range of characters in the read buffer that remains valid until the next line is read.
+	//! The buffer is only enlarged when a single line does not fit in it.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2014-2019
+	class TextFileReader {
+	public:
+		//! \brief Constructs a reader for the specified input stream.
+		//! \param input is the already open input stream.
+		//! \param buffer_size is the size of the read buffer in bytes.
+		TextFileReader(std::istream& input, const size_t buffer_size = 1 << 20);
+
+		//! \brief Gets the next line of the input stream without the line terminator.
+		//! \details Both LF and CRLF line terminators are accepted, and the last line does not need to end with a line terminator.
+		//! \param line_begin is set to point to the first character of the line.
+		//! \param line_end is set to point one past the last character of the line.
+		//! \return true if a line was read.
+		//! \return false if the end of the input stream has been reached.
+		bool getLine(const char*& line_begin, const char*& line_end);
+
+	private:
+		std::istream& Input;
+		std::vector<char> Buffer;
+		size_t Begin = 0;
+		size_t End = 0;
+		bool End_of_input = false;
+	};
+
 	// Scientific Constants
 	static constexpr double K_b = 8.61733035e-5;
 	static constexpr double Elementary_charge = 1.602176621e-19; // C
@@ -210,6 +407,29 @@ namespace Ising_OPV {
 	//! \return An empty vector when called on other processors.
 	std::vector<int> MPI_gatherVectors(const std::vector<int>& input_vector);
 
+	//! \brief Receives a data buffer that was sent from the source processor using MPI_sendBuffer.
+	//! \details The total size of the incoming buffer is received first, so the receiving processor does not need to know the buffer size or the chunk size in advance.
+	//! \param source is the ID of the processor that sent the buffer.
+	//! \return The received data buffer.
+	std::vector<char> MPI_receiveBuffer(const int source);
+
+	//! \brief Sends a data buffer from the calling processor to the destination processor, where it must be received using MPI_receiveBuffer.
+	//! \details The buffer is sent as a sequence of messages, so that buffers larger than the maximum int count of a single MPI message can be sent.
+	//! \param buffer is the data buffer to be sent.
+	//! \param destination is the ID of the processor that will receive the buffer.
+	//! \param max_chunk_size is the maximum number of bytes sent in each message.
+	//! \throws invalid_argument if the maximum chunk size is not positive.
+	void MPI_sendBuffer(const std::vector<char>& buffer, const int destination, const int max_chunk_size = std::numeric_limits<int>::max());
+
+	//! \brief Parses an integer value from a range of characters without allocating memory, similar to std::from_chars.
+	//! \details Leading spaces and tabs and an optional sign are accepted before the digits.
+	//! \param pos points to the first character to be parsed and is advanced past the parsed value when successful.
+	//! \param end points one past the last character of the range.
+	//! \param value is set to the parsed value when successful.
+	//! \return true if an integer value was parsed.
+	//! \return false if the range does not start with an integer value.
+	bool parseInteger(const char*& pos, const char* end, long int& value);
+
 	//! \brief Removes all spaces and ta characters in a string.
 	//! \param str is the input string
 	//! \returns a new string that will have the whitespace removed.
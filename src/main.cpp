@@ -39,10 +39,12 @@ int main(int argc, char * argv[]) {
 	ofstream analysis_file;
 	ofstream areal_composition_file;
 	ofstream areal_tortuosity_file;
+	ofstream chord_length_hist_file;
 	ofstream correlation_avg_file;
 	ofstream correlation_file;
 	ofstream depthdata_avg_file;
 	ofstream depthdata_file;
+	ofstream domain_volume_hist_file;
 	ofstream interfacial_dist_hist_file;
 	ofstream morphology_output_file;
 	ofstream morphology_cross_section_file;
@@ -64,6 +66,14 @@ int main(int argc, char * argv[]) {
 	vector<double> tortuosity_hist2_vect;
 	vector<pair<double, double>> interfacial_dist_probhist1;
 	vector<pair<double, double>> interfacial_dist_probhist2;
+	vector<vector<pair<double, double>>> chord_length_probhists;
+	vector<vector<double>> mean_chord_lengths;
+	vector<pair<double, double>> domain_volume_probhist1;
+	vector<pair<double, double>> domain_volume_probhist2;
+	vector<double> connected_fractions1;
+	vector<double> connected_fractions2;
+	vector<double> percolating_fractions1;
+	vector<double> percolating_fractions2;
 	vector<double> correlation1_vect;
 	vector<double> correlation2_vect;
 	vector<double> depth_comp1_vect;
@@ -113,47 +123,75 @@ int main(int argc, char * argv[]) {
 			}
 			// Collect tomogram import options
 			cout << procid << ": Loading and analyzing tomogram data." << endl;
-			vector<Morphology> morphology_set = morph.importTomogramMorphologyFile();
+			// The tomogram data is kept by a separate Morphology object, so that it is released once the morphology set has been distributed
+			// Each morphology is sent directly to the processor that will analyze it as a binary data buffer as soon as it is created, and the first one is kept by this processor
+			Morphology tomogram_morph(parameters, procid);
+			int N_morphologies = 0;
+			vector<char> buffer;
+			vector<char> buffer_local;
+			auto distribute_morphology = [&](Morphology& morph_new) {
+				if (N_morphologies == 0) {
+					morph_new.outputMorphologyBuffer(buffer_local);
+				}
+				else if (N_morphologies < nproc) {
+					cout << procid << ": Sending morphology " << N_morphologies << " to processor " << N_morphologies << "." << endl;
+					morph_new.outputMorphologyBuffer(buffer);
+					MPI_sendBuffer(buffer, N_morphologies);
+				}
+				N_morphologies++;
+			};
+			tomogram_morph.importTomogramMorphologyFile(distribute_morphology);
 			// Check that a set of morphologies has been produced
-			if (morphology_set.size() == 0) {
+			if (N_morphologies == 0) {
 				cout << procid << ": Error! Morphology set could not be generated from the input tomogram. Program will exit now." << endl;
 				return 0;
 			}
+			// Additional variants reuse the tomogram data analyzed by the first import and only repeat the assignment of the mixed phase sites
 			for (int i = 1; i < parameters.N_variants; i++) {
-				vector<Morphology> morphology_set2 = morph.importTomogramMorphologyFile();
-				morphology_set.insert(morphology_set.end(), morphology_set2.begin(), morphology_set2.end());
-			}
-			// Output morphology set to separate files
-			for (int i = 0; i < (int)morphology_set.size(); i++) {
-				cout << procid << ": Writing morphology " << i << " to an output file." << endl;
-				filename = "morphology_" + to_string(i) + ".txt";
-				morphology_output_file.open(filename);
-				morphology_set[i].outputMorphologyFile(morphology_output_file, parameters.Enable_export_compressed_files);
-				morphology_output_file.close();
+				tomogram_morph.importTomogramMorphologyFile(distribute_morphology);
 			}
-		}
-		// All processors must wait until the root proc finishes with morphology set generation.
-		MPI_Barrier(MPI_COMM_WORLD);
-	}
-	if (parameters.Enable_import_morphologies || parameters.Enable_import_tomogram) {
-		filename = "morphology_" + to_string(procid) + ".txt";
-		cout << procid << ": Opening morphology file " << filename << endl;
-		morphology_input_file.open(filename);
-		if (morphology_input_file.is_open()) {
-			cout << procid << ": Morphology file successfully opened!" << endl;
+			success = morph.importMorphologyBuffer(buffer_local);
 		}
 		else {
-			cout << procid << ": Opening morphology file failed! Program will exit now!" << endl;
-			return 0;
+			success = morph.importMorphologyBuffer(MPI_receiveBuffer(0));
 		}
-		cout << procid << ": Importing morphology from file..." << flush;
-		// Import the morphology from the given data file.
-		success = morph.importMorphologyFile(morphology_input_file);
 		if (!success) {
-			cout << procid << ": Importing morphology file failed! Program will exit now!" << endl;
+			cout << procid << ": Importing morphology from the tomogram data failed! Program will exit now!" << endl;
 			return 0;
 		}
-		morphology_input_file.close();
+		cout << procid << ": Morphology import complete!" << endl;
+	}
+	else if (parameters.Enable_import_morphologies) {
+		// When the binary file format is enabled, the morphologies are imported from the binary morphology files instead of the morphology text files.
+		if (parameters.Enable_export_binary_files) {
+			filename = "morphology_" + to_string(procid) + ".bin";
+			cout << procid << ": Importing morphology from binary file " << filename << "..." << endl;
+			success = morph.importMorphologyBinaryFile(filename);
+			if (!success) {
+				cout << procid << ": Importing binary morphology file failed! Program will exit now!" << endl;
+				return 0;
+			}
+		}
+		else {
+			filename = "morphology_" + to_string(procid) + ".txt";
+			cout << procid << ": Opening morphology file " << filename << endl;
+			morphology_input_file.open(filename);
+			if (morphology_input_file.is_open()) {
+				cout << procid << ": Morphology file successfully opened!" << endl;
+			}
+			else {
+				cout << procid << ": Opening morphology file failed! Program will exit now!" << endl;
+				return 0;
+			}
+			cout << procid << ": Importing morphology from file..." << flush;
+			// Import the morphology from the given data file.
+			success = morph.importMorphologyFile(morphology_input_file);
+			if (!success) {
+				cout << procid << ": Importing morphology file failed! Program will exit now!" << endl;
+				return 0;
+			}
+			morphology_input_file.close();
+		}
 		cout << procid << ": Morphology import complete!" << endl;
 	}
 	// Create new morphology if import is disabled.
@@ -188,7 +226,7 @@ int main(int argc, char * argv[]) {
 			cout << procid << ": Initial blend ratio is " << morph.getMixFraction((char)1) << endl;
 			if (parameters.Enable_smoothing) {
 				cout << procid << ": Executing standard smoothing with a smoothing threshold of " << parameters.Smoothing_threshold << "..." << endl;
-				morph.executeSmoothing(parameters.Smoothing_threshold, 1);
+				morph.executeSmoothing(parameters.Smoothing_threshold, 1, parameters.Enable_parallel_smoothing);
 				cout << procid << ": Blend ratio after smoothing is " << morph.getMixFraction((char)1) << endl;
 			}
 			cout << procid << ": Shrinking lattice by a factor of " << parameters.Rescale_factor << " ..." << endl;
@@ -209,11 +247,11 @@ int main(int argc, char * argv[]) {
 	if (parameters.Enable_smoothing && !parameters.Enable_shrink && !parameters.Enable_analysis_only) {
 		if (!parameters.Enable_rescale) {
 			cout << procid << ": Executing standard smoothing with a smoothing threshold of " << parameters.Smoothing_threshold << "..." << endl;
-			morph.executeSmoothing(parameters.Smoothing_threshold, 1);
+			morph.executeSmoothing(parameters.Smoothing_threshold, 1, parameters.Enable_parallel_smoothing);
 		}
 		else {
 			cout << procid << ": Executing rescale factor dependent smoothing with a smoothing threshold of " << parameters.Smoothing_threshold << "..." << endl;
-			morph.executeSmoothing(parameters.Smoothing_threshold, parameters.Rescale_factor);
+			morph.executeSmoothing(parameters.Smoothing_threshold, parameters.Rescale_factor, parameters.Enable_parallel_smoothing);
 		}
 	}
 	// Perform interfacial mixing if enabled.
@@ -237,7 +275,17 @@ int main(int argc, char * argv[]) {
 	// Calculate interfacial distance histogram if enabled.
 	if (parameters.Enable_interfacial_distance_calc) {
 		cout << procid << ": Calculating the interfacial distance histogram..." << endl;
-		morph.calculateInterfacialDistanceHistogram();
+		morph.calculateInterfacialDistanceHistogram(parameters.Enable_chamfer_interfacial_distance_calc);
+	}
+	// Calculate the chord length histograms if enabled.
+	if (parameters.Enable_chord_length_calc) {
+		cout << procid << ": Calculating the chord length distributions..." << endl;
+		morph.calculateChordLengthDistributions();
+	}
+	// Calculate the domain connectivity if enabled.
+	if (parameters.Enable_connectivity_calc) {
+		cout << procid << ": Calculating the domain connectivity..." << endl;
+		morph.calculateDomainConnectivity(parameters.N_connectivity_neighbors);
 	}
 	// Calculate interfacial area to volume ratio.
 	iav_ratio = morph.calculateInterfacialAreaVolumeRatio();
@@ -247,14 +295,16 @@ int main(int argc, char * argv[]) {
 	mix_ratio = morph.getMixFraction((char)1);
 	// Calculate end-to-end tortuosity, tortuosity histogram, and island volume fraction.
 	if (parameters.Enable_tortuosity_calc) {
-		if (parameters.Enable_reduced_memory_tortuosity_calc) {
+		if (parameters.Enable_out_of_core_tortuosity_calc) {
+			cout << procid << ": Calculating tortuosity using the out-of-core method..." << endl;
+		}
+		else if (parameters.Enable_reduced_memory_tortuosity_calc) {
 			cout << procid << ": Calculating tortuosity using the reduced memory method..." << endl;
 		}
 		else {
 			cout << procid << ": Calculating tortuosity using the standard method..." << endl;
 		}
-		success = morph.calculateTortuosity((char)1, parameters.Enable_reduced_memory_tortuosity_calc);
-		success = morph.calculateTortuosity((char)2, parameters.Enable_reduced_memory_tortuosity_calc);
+		success = morph.calculateTortuosities(parameters.Enable_reduced_memory_tortuosity_calc, parameters.Enable_out_of_core_tortuosity_calc);
 		if (!success) {
 			cout << procid << ": Error calculating tortuosity! Program will exit now." << endl;
 			return 0;
@@ -285,12 +335,19 @@ int main(int argc, char * argv[]) {
 		morph.outputCompositionMaps(areal_composition_file);
 		areal_composition_file.close();
 	}
-	// Save final morphology to a text file.
+	// Save final morphology to a text file or to a binary file if enabled.
 	if (!parameters.Enable_analysis_only || parameters.Enable_import_tomogram) {
 		cout << procid << ": Writing morphology to file..." << endl;
-		filename = "morphology_" + to_string(procid) + ".txt";
-		morphology_output_file.open(filename);
-		morph.outputMorphologyFile(morphology_output_file, parameters.Enable_export_compressed_files);
+		if (parameters.Enable_export_binary_files) {
+			filename = "morphology_" + to_string(procid) + ".bin";
+			morphology_output_file.open(filename, ofstream::out | ofstream::binary);
+			morph.outputMorphologyBinaryFile(morphology_output_file);
+		}
+		else {
+			filename = "morphology_" + to_string(procid) + ".txt";
+			morphology_output_file.open(filename);
+			morph.outputMorphologyFile(morphology_output_file, parameters.Enable_export_compressed_files);
+		}
 		morphology_output_file.close();
 	}
 	// Save the cross-section of the x=0 plane to a file if enabled.
@@ -321,6 +378,24 @@ int main(int argc, char * argv[]) {
 		interfacial_dist_probhist1 = MPI_calculateProbHistAvg(hist1);
 		interfacial_dist_probhist2 = MPI_calculateProbHistAvg(hist2);
 	}
+	// Calculate the average chord length histograms and gather the mean chord lengths for each type in the x-, y-, and z-directions.
+	if (parameters.Enable_chord_length_calc) {
+		for (int n = 1; n <= 2; n++) {
+			for (int direction = 1; direction <= 3; direction++) {
+				chord_length_probhists.push_back(MPI_calculateProbHistAvg(morph.getChordLengthHistogram((char)n, direction)));
+				mean_chord_lengths.push_back(MPI_gatherValues(morph.getMeanChordLength((char)n, direction)));
+			}
+		}
+	}
+	// Calculate the average domain volume histograms and gather the electrode connectivity and percolation data.
+	if (parameters.Enable_connectivity_calc) {
+		domain_volume_probhist1 = MPI_calculateProbHistAvg(morph.getDomainVolumeHistogram((char)1));
+		domain_volume_probhist2 = MPI_calculateProbHistAvg(morph.getDomainVolumeHistogram((char)2));
+		connected_fractions1 = MPI_gatherValues(morph.getConnectedVolumeFraction((char)1));
+		connected_fractions2 = MPI_gatherValues(morph.getConnectedVolumeFraction((char)2));
+		percolating_fractions1 = MPI_gatherValues(morph.getPercolatingVolumeFraction((char)1));
+		percolating_fractions2 = MPI_gatherValues(morph.getPercolatingVolumeFraction((char)2));
+	}
 	// Calculate the average pair-pair correlation functions.
 	if (parameters.Enable_correlation_calc) {
 		correlation1_vect = MPI_calculateVectorAvg(morph.getCorrelationData((char)1));
@@ -411,6 +486,42 @@ int main(int argc, char * argv[]) {
 			}
 			interfacial_dist_hist_file.close();
 		}
+		// Output the chord length histograms.
+		if (parameters.Enable_chord_length_calc) {
+			chord_length_hist_file.open("chord_length_histograms.txt");
+			chord_length_hist_file << "Chord_length (a),Probability1_x,Probability1_y,Probability1_z,Probability2_x,Probability2_y,Probability2_z" << endl;
+			int hist_size = 0;
+			for (const auto& item : chord_length_probhists) {
+				if ((int)item.size() > hist_size) {
+					hist_size = (int)item.size();
+				}
+			}
+			for (int i = 0; i < hist_size; i++) {
+				chord_length_hist_file << i + 1;
+				for (const auto& item : chord_length_probhists) {
+					if (i < (int)item.size()) {
+						chord_length_hist_file << "," << item[i].second;
+					}
+					else {
+						chord_length_hist_file << ",0";
+					}
+				}
+				chord_length_hist_file << endl;
+			}
+			chord_length_hist_file.close();
+		}
+		// Output the domain volume histograms.
+		if (parameters.Enable_connectivity_calc) {
+			domain_volume_hist_file.open("domain_volume_histograms.txt");
+			domain_volume_hist_file << "Domain_volume_min (sites),Probability1,Probability2" << endl;
+			int hist_size = (int)max(domain_volume_probhist1.size(), domain_volume_probhist2.size());
+			for (int i = 0; i < hist_size; i++) {
+				domain_volume_hist_file << (1L << i);
+				domain_volume_hist_file << "," << ((i < (int)domain_volume_probhist1.size()) ? domain_volume_probhist1[i].second : 0.0);
+				domain_volume_hist_file << "," << ((i < (int)domain_volume_probhist2.size()) ? domain_volume_probhist2[i].second : 0.0) << endl;
+			}
+			domain_volume_hist_file.close();
+		}
 		// Output the average depth dependent data.
 		if (parameters.Enable_depth_dependent_calc) {
 			depthdata_avg_file.open("depth_dependent_data_avg.txt");
@@ -492,6 +603,29 @@ int main(int argc, char * argv[]) {
 			int index = vector_which_median(tortuosities1);
 			analysis_file << "Morphology number " << index << " has the median tortuosity1 of " << tortuosities1[index] << endl;
 		}
+		if (parameters.Enable_chord_length_calc) {
+			analysis_file << endl;
+			analysis_file << "Mean chord lengths (a) for this morphology set:" << endl;
+			analysis_file << "chord1_x_avg,chord1_x_stdev,chord1_y_avg,chord1_y_stdev,chord1_z_avg,chord1_z_stdev,";
+			analysis_file << "chord2_x_avg,chord2_x_stdev,chord2_y_avg,chord2_y_stdev,chord2_z_avg,chord2_z_stdev" << endl;
+			for (int i = 0; i < (int)mean_chord_lengths.size(); i++) {
+				if (i > 0) {
+					analysis_file << ",";
+				}
+				analysis_file << vector_avg(mean_chord_lengths[i]) << "," << vector_stdev(mean_chord_lengths[i]);
+			}
+			analysis_file << endl;
+		}
+		if (parameters.Enable_connectivity_calc) {
+			analysis_file << endl;
+			analysis_file << "Domain connectivity for this morphology set:" << endl;
+			analysis_file << "connected_fraction1_avg,connected_fraction1_stdev,connected_fraction2_avg,connected_fraction2_stdev,";
+			analysis_file << "percolating_fraction1_avg,percolating_fraction1_stdev,percolating_fraction2_avg,percolating_fraction2_stdev" << endl;
+			analysis_file << vector_avg(connected_fractions1) << "," << vector_stdev(connected_fractions1) << ",";
+			analysis_file << vector_avg(connected_fractions2) << "," << vector_stdev(connected_fractions2) << ",";
+			analysis_file << vector_avg(percolating_fractions1) << "," << vector_stdev(percolating_fractions1) << ",";
+			analysis_file << vector_avg(percolating_fractions2) << "," << vector_stdev(percolating_fractions2) << endl;
+		}
 		if (parameters.Enable_import_tomogram) {
 			analysis_file << endl;
 			analysis_file << "Morphologies imported from tomogram dataset: " << parameters.Tomogram_name << endl;
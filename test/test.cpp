@@ -197,6 +197,23 @@ namespace ParametersTests {
 		params_invalid = params;
 		params_invalid.Enable_mix_frac_method = true;
 		EXPECT_FALSE(params_invalid.checkParameters());
+		// Check invalid progressive correlation tolerance
+		params_invalid = params;
+		params_invalid.Enable_correlation_calc = true;
+		params_invalid.Enable_progressive_correlation_calc = true;
+		params_invalid.Correlation_tolerance = 0.0;
+		EXPECT_FALSE(params_invalid.checkParameters());
+		// Check invalid tortuosity calculation options
+		params_invalid = params;
+		params_invalid.Enable_tortuosity_calc = true;
+		params_invalid.Enable_reduced_memory_tortuosity_calc = true;
+		params_invalid.Enable_out_of_core_tortuosity_calc = true;
+		EXPECT_FALSE(params_invalid.checkParameters());
+		// Check invalid domain connectivity calculation options
+		params_invalid = params;
+		params_invalid.Enable_connectivity_calc = true;
+		params_invalid.N_connectivity_neighbors = 8;
+		EXPECT_FALSE(params_invalid.checkParameters());
 		// Check invalid N_sampling
 		params_invalid = params;
 		params_invalid.N_sampling_max = -1;
@@ -228,6 +245,17 @@ namespace ParametersTests {
 		params_invalid.Enable_import_tomogram = true;
 		params_invalid.Desired_unit_size = 0.0;
 		EXPECT_FALSE(params_invalid.checkParameters());
+		// Check invalid interpolation order
+		params_invalid = params;
+		params_invalid.Enable_import_tomogram = true;
+		params_invalid.Tomogram_interpolation_order = 2;
+		EXPECT_FALSE(params_invalid.checkParameters());
+		// Check invalid tile budget
+		params_invalid = params;
+		params_invalid.Enable_import_tomogram = true;
+		params_invalid.Enable_tiled_tomogram_import = true;
+		params_invalid.Tomogram_tile_budget = 0;
+		EXPECT_FALSE(params_invalid.checkParameters());
 		// Check invalid Mixed_frac
 		params_invalid = params;
 		params_invalid.Enable_import_tomogram = true;
@@ -419,6 +447,57 @@ namespace UtilsTests {
 		EXPECT_THROW(str2bool("	blah  "), invalid_argument);
 	}
 
+	TEST(UtilsTests, IndexedMinHeapTests) {
+		IndexedMinHeap heap(10);
+		EXPECT_TRUE(heap.empty());
+		EXPECT_TRUE(heap.push(3, 2.5f));
+		EXPECT_TRUE(heap.push(7, 1.5f));
+		EXPECT_TRUE(heap.push(1, 3.5f));
+		EXPECT_TRUE(heap.push(5, 1.5f));
+		EXPECT_EQ(4, heap.size());
+		EXPECT_TRUE(heap.contains(1));
+		EXPECT_FALSE(heap.contains(2));
+		// Check that equal keys are ordered by index
+		EXPECT_EQ(5, heap.getTopIndex());
+		EXPECT_FLOAT_EQ(1.5f, heap.getTopKey());
+		// Check that a larger key does not replace the current key
+		EXPECT_FALSE(heap.push(1, 4.0f));
+		EXPECT_FLOAT_EQ(3.5f, heap.getKey(1));
+		// Check that decreasing a key moves the item to the top
+		EXPECT_TRUE(heap.push(1, 0.5f));
+		EXPECT_EQ(1, heap.getTopIndex());
+		// Check that items are popped in order of increasing key
+		vector<long int> indices;
+		while (!heap.empty()) {
+			indices.push_back(heap.getTopIndex());
+			heap.pop();
+		}
+		vector<long int> indices_expected = { 1, 5, 7, 3 };
+		EXPECT_EQ(indices_expected, indices);
+		EXPECT_FALSE(heap.contains(1));
+		// Check ordering with many items and random keys
+		IndexedMinHeap heap2(1000);
+		mt19937_64 gen(1);
+		uniform_real_distribution<float> dist(0.0f, 100.0f);
+		for (long int i = 0; i < 1000; i++) {
+			heap2.push(i, dist(gen));
+		}
+		for (long int i = 0; i < 1000; i += 3) {
+			heap2.push(i, heap2.getKey(i) / 2);
+		}
+		float key_prev = -1.0f;
+		while (!heap2.empty()) {
+			EXPECT_LE(key_prev, heap2.getTopKey());
+			key_prev = heap2.getTopKey();
+			heap2.pop();
+		}
+		// Check that the heap can be cleared and reused
+		heap.push(2, 1.0f);
+		heap.clear();
+		EXPECT_TRUE(heap.empty());
+		EXPECT_FALSE(heap.contains(2));
+	}
+
 	TEST(UtilsTests, IntegrateDataTests) {
 		vector<pair<double, double>> data_vec = { { 0.0,0.0 },{ 1.0,1.0 },{ 2.0,2.0 },{ 3.0,3.0 } };
 		auto area = integrateData(data_vec);
@@ -444,6 +523,50 @@ namespace UtilsTests {
 
 	}
 
+	TEST(UtilsTests, ParseIntegerTests) {
+		string str = "  -42,7x";
+		const char* pos = str.data();
+		const char* end = str.data() + str.size();
+		long int value = 0;
+		EXPECT_TRUE(parseInteger(pos, end, value));
+		EXPECT_EQ(-42, value);
+		EXPECT_EQ(',', *pos);
+		EXPECT_FALSE(parseInteger(pos, end, value));
+		EXPECT_EQ(-42, value);
+		pos++;
+		EXPECT_TRUE(parseInteger(pos, end, value));
+		EXPECT_EQ(7, value);
+		EXPECT_EQ('x', *pos);
+		// The range end is respected even when more digits follow
+		str = "12345";
+		pos = str.data();
+		EXPECT_TRUE(parseInteger(pos, str.data() + 3, value));
+		EXPECT_EQ(123, value);
+		pos = str.data();
+		EXPECT_FALSE(parseInteger(pos, str.data(), value));
+	}
+
+	TEST(UtilsTests, TextFileReaderTests) {
+		// Use a buffer smaller than the lines to check that lines spanning buffer refills are returned whole
+		stringstream input("first line\r\nsecond\n\na much longer third line");
+		TextFileReader reader(input, 4);
+		const char* line_begin;
+		const char* line_end;
+		EXPECT_TRUE(reader.getLine(line_begin, line_end));
+		EXPECT_EQ("first line", string(line_begin, line_end));
+		EXPECT_TRUE(reader.getLine(line_begin, line_end));
+		EXPECT_EQ("second", string(line_begin, line_end));
+		EXPECT_TRUE(reader.getLine(line_begin, line_end));
+		EXPECT_EQ("", string(line_begin, line_end));
+		EXPECT_TRUE(reader.getLine(line_begin, line_end));
+		EXPECT_EQ("a much longer third line", string(line_begin, line_end));
+		EXPECT_FALSE(reader.getLine(line_begin, line_end));
+		// Check an empty input stream
+		stringstream empty_input("");
+		TextFileReader empty_reader(empty_input);
+		EXPECT_FALSE(empty_reader.getLine(line_begin, line_end));
+	}
+
 	TEST(UtilsTests, RemoveWhitespaceTests) {
 		string str = " text          ";
 		EXPECT_EQ(removeWhitespace(str), "text");
@@ -604,6 +727,14 @@ namespace LatticeTests {
 		EXPECT_DOUBLE_EQ(1.0, lattice.getUnitSize());
 		EXPECT_EQ((long int)50 * 50 * 50, lattice.getNumSites());
 		EXPECT_DOUBLE_EQ(125000e-21, lattice.getVolume());
+		// Check that the modification count is incremented by each change to the lattice
+		unsigned long modification_count = lattice.getModificationCount();
+		EXPECT_LT(0UL, modification_count);
+		lattice.setSiteType(0, (char)1);
+		lattice.setSiteType(1, 1, 1, (char)2);
+		EXPECT_EQ(modification_count + 2, lattice.getModificationCount());
+		lattice.resize(20, 20, 20);
+		EXPECT_EQ(modification_count + 3, lattice.getModificationCount());
 	}
 
 	TEST_F(LatticeTest, CalculateDestCoordsTests) {
@@ -1039,6 +1170,15 @@ namespace MorphologyTests {
 		EXPECT_NEAR(0.5, morph.getMixFraction((char)2), 0.01);
 		// Check the interfacial volume fraction
 		EXPECT_DOUBLE_EQ(1.0, morph.calculateInterfacialVolumeFraction());
+		// Shrink the checkerboard morphology, where every block has an equal number of each site type
+		morph.shrinkLattice(2);
+		// Check that the ties are broken by alternating site types, which creates a layered morphology with alternating z-planes
+		EXPECT_EQ(20, morph.getHeight());
+		EXPECT_DOUBLE_EQ(0.5, morph.getMixFraction((char)1));
+		EXPECT_DOUBLE_EQ(1.0, morph.calculateInterfacialVolumeFraction());
+		morph.calculateDepthDependentData();
+		EXPECT_DOUBLE_EQ(1.0, morph.getDepthCompositionData((char)1)[0]);
+		EXPECT_DOUBLE_EQ(0.0, morph.getDepthCompositionData((char)1)[1]);
 	}
 
 	TEST(MorphologyTests, ImportTomogramTests) {
@@ -1106,6 +1246,79 @@ namespace MorphologyTests {
 		EXPECT_EQ(100, morphologies[0].getHeight());
 		EXPECT_NEAR(0.5, morphologies[0].getMixFraction((char)1), 0.01);
 		EXPECT_NEAR(0.5, morphologies[0].getMixFraction((char)2), 0.01);
+		// Check that the brightness thresholds give the exact number of each site type with a mixed phase
+		params.Mixed_frac = 0.1;
+		morph = Morphology(params, 0);
+		morphologies = morph.importTomogramMorphologyFile();
+		EXPECT_DOUBLE_EQ(0.5, morphologies[0].getMixFraction((char)1));
+		EXPECT_DOUBLE_EQ(0.5, morphologies[0].getMixFraction((char)2));
+		// Check that a second variant created from the loaded tomogram data has a different random mixed phase
+		auto morphologies2 = morph.importTomogramMorphologyFile();
+		EXPECT_EQ(1, (int)morphologies2.size());
+		EXPECT_EQ(200, morphologies2[0].getLength());
+		EXPECT_DOUBLE_EQ(0.5, morphologies2[0].getMixFraction((char)1));
+		EXPECT_NE(morphologies[0].calculateInterfacialAreaVolumeRatio(), morphologies2[0].calculateInterfacialAreaVolumeRatio());
+		EXPECT_NEAR(morphologies[0].calculateInterfacialAreaVolumeRatio(), morphologies2[0].calculateInterfacialAreaVolumeRatio(), 0.01);
+		params.Mixed_frac = 0.0;
+		// Check that changing the mixed volume fraction with setParameters reloads the tomogram data instead of reusing the loaded mixed phase
+		morph.setParameters(params);
+		morphologies2 = morph.importTomogramMorphologyFile();
+		Morphology morph_reload(params, 0);
+		auto morphologies_reload = morph_reload.importTomogramMorphologyFile();
+		vector<char> buffer_reload;
+		vector<char> buffer_reload2;
+		morphologies2[0].outputMorphologyBuffer(buffer_reload);
+		morphologies_reload[0].outputMorphologyBuffer(buffer_reload2);
+		EXPECT_TRUE(buffer_reload == buffer_reload2);
+		EXPECT_LT(morphologies2[0].calculateInterfacialVolumeFraction(), morphologies[0].calculateInterfacialVolumeFraction());
+		// Check trilinear and tricubic interpolation of 8 bit data
+		for (int order : {1, 3}) {
+			params.Tomogram_interpolation_order = order;
+			morph = Morphology(params, 0);
+			morphologies = morph.importTomogramMorphologyFile();
+			EXPECT_EQ(200, morphologies[0].getLength());
+			EXPECT_EQ(200, morphologies[0].getWidth());
+			EXPECT_EQ(100, morphologies[0].getHeight());
+			EXPECT_NEAR(0.5, morphologies[0].getMixFraction((char)1), 0.01);
+			EXPECT_NEAR(iv_frac_i, morphologies[0].calculateInterfacialVolumeFraction(), 0.05);
+		}
+		params.N_extracted_segments = 4;
+		// Check that tiled processing in small z-bricks creates the same morphologies as processing in memory
+		for (int order : {0, 3}) {
+			params.Tomogram_interpolation_order = order;
+			morph = Morphology(params, 0);
+			morphologies = morph.importTomogramMorphologyFile();
+			params.Enable_tiled_tomogram_import = true;
+			params.Tomogram_tile_budget = 1;
+			morph = Morphology(params, 0);
+			morphologies2 = morph.importTomogramMorphologyFile();
+			params.Enable_tiled_tomogram_import = false;
+			ASSERT_EQ(morphologies.size(), morphologies2.size());
+			for (int i = 0; i < (int)morphologies.size(); i++) {
+				vector<char> buffer;
+				vector<char> buffer2;
+				morphologies[i].outputMorphologyBuffer(buffer);
+				morphologies2[i].outputMorphologyBuffer(buffer2);
+				EXPECT_TRUE(buffer == buffer2);
+			}
+		}
+		params.Tomogram_interpolation_order = 0;
+		// Check tiled processing with a mixed phase
+		params.Enable_tiled_tomogram_import = true;
+		params.Mixed_frac = 0.1;
+		params.N_extracted_segments = 1;
+		morph = Morphology(params, 0);
+		morphologies = morph.importTomogramMorphologyFile();
+		EXPECT_EQ(1, (int)morphologies.size());
+		EXPECT_EQ(200, morphologies[0].getLength());
+		EXPECT_EQ(200, morphologies[0].getWidth());
+		EXPECT_EQ(100, morphologies[0].getHeight());
+		EXPECT_DOUBLE_EQ(0.5, morphologies[0].getMixFraction((char)1));
+		morphologies2 = morph.importTomogramMorphologyFile();
+		EXPECT_DOUBLE_EQ(0.5, morphologies2[0].getMixFraction((char)1));
+		EXPECT_NE(morphologies[0].calculateInterfacialAreaVolumeRatio(), morphologies2[0].calculateInterfacialAreaVolumeRatio());
+		params.Enable_tiled_tomogram_import = false;
+		params.Mixed_frac = 0.0;
 		params.N_extracted_segments = 4;
 		// Check extraction of 36 segments
 		params.N_extracted_segments = 36;
@@ -1246,6 +1459,65 @@ namespace MorphologyTests {
 		// Check that the domain size is almost the same
 		EXPECT_NEAR(domain_size1_i, domain_size1_f, 0.025);
 		EXPECT_NEAR(domain_size2_i, domain_size2_f, 0.025);
+		// Try domain size calculation using a small random sampling of sites
+		params.N_sampling_max = 5000;
+		morph.setParameters(params);
+		morph.calculateCorrelationDistances();
+		// Check that the domain size is still approximately the same
+		EXPECT_NEAR(domain_size1_i, morph.getDomainSize((char)1), 0.2);
+		EXPECT_NEAR(domain_size2_i, morph.getDomainSize((char)2), 0.2);
+		// Check that no domain size error is recorded without the progressive calculation
+		EXPECT_DOUBLE_EQ(-1.0, morph.getDomainSizeError((char)1));
+		params.N_sampling_max = 100000;
+		morph.setParameters(params);
+		// Try the progressive domain size calculation
+		params.Enable_progressive_correlation_calc = true;
+		params.Correlation_tolerance = 0.005;
+		morph.setParameters(params);
+		morph.calculateCorrelationDistances();
+		// Check that the domain size is approximately the same and that the target error has been reached
+		EXPECT_NEAR(domain_size1_i, morph.getDomainSize((char)1), 0.1);
+		EXPECT_NEAR(domain_size2_i, morph.getDomainSize((char)2), 0.1);
+		EXPECT_GT(morph.getDomainSizeError((char)1), 0.0);
+		EXPECT_LT(morph.getDomainSizeError((char)1), 0.005 * morph.getDomainSize((char)1));
+		EXPECT_LT(morph.getDomainSizeError((char)2), 0.005 * morph.getDomainSize((char)2));
+		// Try the progressive domain size calculation with a target error that cannot be reached, so that all sampled sites are used
+		params.Correlation_tolerance = 1e-6;
+		morph.setParameters(params);
+		morph.calculateCorrelationDistances();
+		EXPECT_NEAR(domain_size1_i, morph.getDomainSize((char)1), 0.025);
+		EXPECT_NEAR(domain_size2_i, morph.getDomainSize((char)2), 0.025);
+		// Output correlation data with the domain size error
+		ofstream outfile1("./test/correlation_data.txt");
+		morph.outputCorrelationData(outfile1);
+		outfile1.close();
+		ifstream infile1("./test/correlation_data.txt");
+		string line1;
+		while (getline(infile1, line1) && !line1.empty()) {}
+		getline(infile1, line1);
+		EXPECT_EQ("Site_type,Domain_size (a),Domain_size_error (a),N_sites", line1);
+		getline(infile1, line1);
+		// All sites of the type are used when the target error cannot be reached
+		EXPECT_EQ(to_string((long int)(morph.getMixFraction((char)1) * 125000 + 0.5)), line1.substr(line1.rfind(',') + 1));
+		infile1.close();
+		// Try the progressive domain size calculation with batches drawn as needed from a sampling that is a small fraction of the sites
+		params.N_sampling_max = 20000;
+		morph.setParameters(params);
+		morph.calculateCorrelationDistances();
+		EXPECT_NEAR(domain_size1_i, morph.getDomainSize((char)1), 0.2);
+		EXPECT_NEAR(domain_size2_i, morph.getDomainSize((char)2), 0.2);
+		outfile1.open("./test/correlation_data.txt");
+		morph.outputCorrelationData(outfile1);
+		outfile1.close();
+		infile1.open("./test/correlation_data.txt");
+		while (getline(infile1, line1) && !line1.empty()) {}
+		getline(infile1, line1);
+		getline(infile1, line1);
+		EXPECT_EQ("20000", line1.substr(line1.rfind(',') + 1));
+		infile1.close();
+		params.N_sampling_max = 100000;
+		params.Enable_progressive_correlation_calc = false;
+		morph.setParameters(params);
 		// Try the extended correlation calculation
 		params.Enable_extended_correlation_calc = true;
 		params.Extended_correlation_cutoff_distance = 5;
@@ -1306,6 +1578,9 @@ namespace MorphologyTests {
 		for (auto item : data) {
 			EXPECT_NEAR(iv_frac_i, item, 0.1);
 		}
+		// Check that the average depth dependent data matches the bulk values
+		EXPECT_NEAR(iv_frac_i, vector_avg(data), 1e-9);
+		EXPECT_NEAR(morph.getMixFraction((char)1), vector_avg(data1), 1e-9);
 		string line;
 		// Output correlation data
 		ofstream outfile2("./test/correlation_data.txt");
@@ -1333,24 +1608,52 @@ namespace MorphologyTests {
 
 	TEST_F(MorphologyTest, TortuosityTests) {
 		Morphology morph = *morph_start;
-		// Calculate the tortuosity
+		// Calculate the tortuosity of both site types
+		EXPECT_TRUE(morph.calculateTortuosities(false, false));
+		double island_fraction1 = morph.getIslandVolumeFraction((char)1);
+		double island_fraction2 = morph.getIslandVolumeFraction((char)2);
+		auto data1_all = morph.getTortuosityData((char)1);
+		auto data2_all = morph.getTortuosityData((char)2);
+		// Calculate the tortuosity of each site type separately and check that only the data of the specified site type is calculated
+		Morphology morph_single = *morph_start;
+		EXPECT_TRUE(morph_single.calculateTortuosity((char)1, false));
+		EXPECT_EQ(data1_all, morph_single.getTortuosityData((char)1));
+		EXPECT_TRUE(morph_single.getTortuosityData((char)2).empty());
 		morph.calculateTortuosity((char)1, false);
 		morph.calculateTortuosity((char)2, false);
 		// Check tortuosity calculation of invalid site type
 		EXPECT_FALSE(morph.calculateTortuosity((char)3, false));
+		// Check that both calculations give the same answer
+		EXPECT_EQ(data1_all, morph.getTortuosityData((char)1));
+		EXPECT_EQ(data2_all, morph.getTortuosityData((char)2));
+		EXPECT_DOUBLE_EQ(island_fraction1, morph.getIslandVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(island_fraction2, morph.getIslandVolumeFraction((char)2));
 		// Check the tortuosity
 		double tortuosity1 = vector_avg(morph.getTortuosityData((char)1));
 		double tortuosity2 = vector_avg(morph.getTortuosityData((char)2));
 		EXPECT_NEAR(1.1, tortuosity1, 0.025);
 		EXPECT_NEAR(1.1, tortuosity2, 0.025);
 		// Calculate the tortuosity using the reduced memory option
-		morph.calculateTortuosity((char)1, true);
-		morph.calculateTortuosity((char)2, true);
+		EXPECT_TRUE(morph.calculateTortuosities(true, false));
 		// Check that both tortuosity methods give the same answer
 		auto data1 = morph.getTortuosityData((char)1);
 		auto data2 = morph.getTortuosityData((char)2);
 		EXPECT_DOUBLE_EQ(tortuosity1, vector_avg(data1));
 		EXPECT_DOUBLE_EQ(tortuosity2, vector_avg(data2));
+		EXPECT_EQ(data1_all, data1);
+		EXPECT_EQ(data2_all, data2);
+		EXPECT_DOUBLE_EQ(island_fraction1, morph.getIslandVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(island_fraction2, morph.getIslandVolumeFraction((char)2));
+		// Calculate the tortuosity using the out-of-core option
+		EXPECT_TRUE(morph.calculateTortuosities(false, true));
+		// Check that the out-of-core method gives the same answer
+		EXPECT_EQ(data1_all, morph.getTortuosityData((char)1));
+		EXPECT_EQ(data2_all, morph.getTortuosityData((char)2));
+		EXPECT_DOUBLE_EQ(island_fraction1, morph.getIslandVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(island_fraction2, morph.getIslandVolumeFraction((char)2));
+		// Check that the scratch file has been removed
+		ifstream scratch_file("tortuosity_scratch_" + to_string(morph.getID()) + ".tmp");
+		EXPECT_FALSE(scratch_file.good());
 		// Output tortuosity maps
 		ofstream outfile("./test/tortuosity_maps.txt");
 		morph.outputTortuosityMaps(outfile);
@@ -1375,7 +1678,7 @@ namespace MorphologyTests {
 		double domain_size1_i = morph.getDomainSize((char)1);
 		double domain_size2_i = morph.getDomainSize((char)2);
 		// Apply smoothing
-		morph.executeSmoothing(0.52, 1);
+		morph.executeSmoothing(0.52, 1, false);
 		// Check that the mix fractions are not severely changed
 		EXPECT_NEAR(0.5, morph.getMixFraction((char)1), 0.02);
 		EXPECT_NEAR(0.5, morph.getMixFraction((char)2), 0.02);
@@ -1393,8 +1696,7 @@ namespace MorphologyTests {
 		EXPECT_LT(iv_frac_f, iv_frac_i);
 		EXPECT_LT(iav_ratio_f, iav_ratio_i);
 		// Calculate the final tortuosity
-		morph.calculateTortuosity((char)1, false);
-		morph.calculateTortuosity((char)2, false);
+		morph.calculateTortuosities(false, false);
 		// Check the tortuosity of an isotropic smoothed phase separated blend
 		auto tortuosity1_avg = vector_avg(morph.getTortuosityData((char)1));
 		auto tortuosity2_avg = vector_avg(morph.getTortuosityData((char)2));
@@ -1403,6 +1705,102 @@ namespace MorphologyTests {
 		// Check the island volume fraction
 		EXPECT_LT(morph.getIslandVolumeFraction((char)1), 0.001);
 		EXPECT_LT(morph.getIslandVolumeFraction((char)2), 0.001);
+		// Apply parallel smoothing to the starting morphology
+		Morphology morph_parallel = *morph_start;
+		morph_parallel.executeSmoothing(0.52, 1, true);
+		EXPECT_NEAR(0.5, morph_parallel.getMixFraction((char)1), 0.02);
+		// Check that the parallel smoothing gives a similar reduction in the interfacial volume fraction
+		EXPECT_LT(morph_parallel.calculateInterfacialVolumeFraction(), iv_frac_i);
+		EXPECT_NEAR(iv_frac_f, morph_parallel.calculateInterfacialVolumeFraction(), 0.01);
+		// Check that rescale dependent parallel smoothing also reduces the interfacial volume fraction
+		morph_parallel = *morph_start;
+		morph_parallel.executeSmoothing(0.52, 3, true);
+		EXPECT_LT(morph_parallel.calculateInterfacialVolumeFraction(), iv_frac_i);
+		// Check the smoothing against a direct implementation of the original smoothing sweeps, which visits the whole neighborhood of each site to calculate its roughness factor
+		auto get_site_types = [](const Morphology& morph_input) {
+			vector<char> buffer;
+			morph_input.outputMorphologyBuffer(buffer);
+			return vector<char>(buffer.end() - (long int)morph_input.getLength() * morph_input.getWidth() * morph_input.getHeight(), buffer.end());
+		};
+		auto calculate_roughness = [](const Lattice& lattice_input, const Coords& coords, const int rescale_factor) {
+			int radius = (rescale_factor <= 2) ? 1 : (int)ceil((double)(rescale_factor + 1) / 2);
+			int cutoff_squared = (rescale_factor <= 2) ? 2 : (int)floor(intpow((rescale_factor + 1.0) / 2.0, 2));
+			int site_count = 0;
+			int count_dissimilar = 0;
+			Coords coords_dest;
+			for (int i = -radius; i <= radius; i++) {
+				for (int j = -radius; j <= radius; j++) {
+					for (int k = -radius; k <= radius; k++) {
+						if ((i*i + j * j + k * k) > cutoff_squared || !lattice_input.checkMoveValidity(coords, i, j, k)) {
+							continue;
+						}
+						lattice_input.calculateDestinationCoords(coords, i, j, k, coords_dest);
+						if (lattice_input.getSiteType(coords) != lattice_input.getSiteType(coords_dest)) {
+							count_dissimilar++;
+						}
+						site_count++;
+					}
+				}
+			}
+			return (double)count_dissimilar / (double)site_count;
+		};
+		auto smooth_lattice = [&calculate_roughness](Lattice& lattice_input, const double smoothing_threshold, const int rescale_factor) {
+			Coords coords;
+			int site_count = 1;
+			while (site_count > 0) {
+				site_count = 0;
+				for (int x = 0; x < lattice_input.getLength(); x++) {
+					for (int y = 0; y < lattice_input.getWidth(); y++) {
+						for (int z = 0; z < lattice_input.getHeight(); z++) {
+							coords.setXYZ(x, y, z);
+							if (calculate_roughness(lattice_input, coords, rescale_factor) > smoothing_threshold) {
+								lattice_input.setSiteType(x, y, z, (lattice_input.getSiteType(x, y, z) == (char)1) ? (char)2 : (char)1);
+								site_count++;
+							}
+						}
+					}
+				}
+			}
+		};
+		// Use a sublattice without periodic boundaries so that the neighbor type counts of the boundary sites are also checked
+		Lattice::Lattice_Params params_lattice;
+		params_lattice.Length = 50;
+		params_lattice.Width = 50;
+		params_lattice.Height = 50;
+		params_lattice.Enable_periodic_x = true;
+		params_lattice.Enable_periodic_y = true;
+		params_lattice.Enable_periodic_z = true;
+		params_lattice.Unit_size = 1.0;
+		Lattice lattice_start;
+		lattice_start.init(params_lattice);
+		lattice_start.setSiteTypes(get_site_types(*morph_start));
+		lattice_start = lattice_start.extractSublattice(0, 40, 0, 40, 0, 20);
+		Parameters params_smoothing = params;
+		params_smoothing.Length = 40;
+		params_smoothing.Width = 40;
+		params_smoothing.Height = 20;
+		params_smoothing.Enable_periodic_z = false;
+		for (int rescale_factor : { 1, 3, 4 }) {
+			// The serial smoothing, which uses the incrementally updated neighbor type counts, should give exactly the same morphology as the original sweeps
+			Morphology morph_serial(lattice_start, params_smoothing, 0);
+			morph_serial.executeSmoothing(0.52, rescale_factor, false);
+			Lattice lattice_reference = lattice_start;
+			smooth_lattice(lattice_reference, 0.52, rescale_factor);
+			EXPECT_EQ(get_site_types(Morphology(lattice_reference, params_smoothing, 0)), get_site_types(morph_serial));
+			// The parallel smoothing visits the sites in a different order, but the neighbor type counts should still agree with a direct count,
+			// so none of the sites in the final morphology should have a roughness factor above the smoothing threshold
+			Morphology morph_parallel_smoothing(lattice_start, params_smoothing, 0);
+			morph_parallel_smoothing.executeSmoothing(0.52, rescale_factor, true);
+			Lattice lattice_parallel = lattice_start;
+			lattice_parallel.setSiteTypes(get_site_types(morph_parallel_smoothing));
+			int rough_count = 0;
+			for (long int n = 0; n < lattice_parallel.getNumSites(); n++) {
+				if (calculate_roughness(lattice_parallel, lattice_parallel.getSiteCoords(n), rescale_factor) > 0.52) {
+					rough_count++;
+				}
+			}
+			EXPECT_EQ(0, rough_count);
+		}
 		// Stretch the lattice
 		morph.stretchLattice(2);
 		// Check the new dimensions
@@ -1425,6 +1823,23 @@ namespace MorphologyTests {
 		// Check the approximate magnitude of the new domain size relative to the original
 		EXPECT_NEAR(domain_size1_f, morph.getDomainSize((char)1), 0.5);
 		EXPECT_NEAR(domain_size2_f, morph.getDomainSize((char)2), 0.5);
+		// Shrink a lattice that only contains type 1 sites
+		params_lattice.Length = 4;
+		params_lattice.Width = 4;
+		params_lattice.Height = 4;
+		Lattice lattice_single;
+		lattice_single.init(params_lattice);
+		lattice_single.setSiteTypes(vector<char>(4 * 4 * 4, (char)1));
+		Parameters params_single = params;
+		params_single.Length = 4;
+		params_single.Width = 4;
+		params_single.Height = 4;
+		Morphology morph_single(lattice_single, params_single, 0);
+		EXPECT_NO_THROW(morph_single.shrinkLattice(2));
+		EXPECT_EQ(2, morph_single.getLength());
+		EXPECT_EQ(2, morph_single.getWidth());
+		EXPECT_EQ(2, morph_single.getHeight());
+		EXPECT_DOUBLE_EQ(1.0, morph_single.getMixFraction((char)1));
 		// Check behavior when trying to stretch and shrink with invalid rescale factors
 		EXPECT_THROW(morph.stretchLattice(0), invalid_argument);
 		EXPECT_THROW(morph.stretchLattice(0), invalid_argument);
@@ -1437,7 +1852,7 @@ namespace MorphologyTests {
 	TEST_F(MorphologyTest, InterfacialTests) {
 		Morphology morph = *morph_start;
 		// Calculate the interfacial distance histogram
-		morph.calculateInterfacialDistanceHistogram();
+		morph.calculateInterfacialDistanceHistogram(false);
 		auto hist1 = morph.getInterfacialDistanceHistogram((char)1);
 		auto hist2 = morph.getInterfacialDistanceHistogram((char)2);
 		auto cum_hist1 = calculateCumulativeHist(calculateProbabilityHist(hist1));
@@ -1445,11 +1860,58 @@ namespace MorphologyTests {
 		// Check that the probability histograms add up to 1
 		EXPECT_DOUBLE_EQ(1.0, cum_hist1.back().second);
 		EXPECT_DOUBLE_EQ(1.0, cum_hist2.back().second);
+		// Check the exact interfacial distances around a single type 2 site on the periodic x and y boundary of a lattice that is not periodic in the z-direction
+		ofstream outfile("./test/interfacial_morphology.txt");
+		outfile << "Ising_OPV v" << Current_version.getVersionStr() << " - compressed format\n20\n20\n21\n1\n1\n0\n2\n0\n0\n0\n0\n";
+		outfile << "110\n21\n1" << 20 * 20 * 21 - 11 << "\n";
+		outfile.close();
+		ifstream infile("./test/interfacial_morphology.txt");
+		Morphology morph_inclusion(params, 0);
+		EXPECT_TRUE(morph_inclusion.importMorphologyFile(infile));
+		infile.close();
+		morph_inclusion.calculateInterfacialDistanceHistogram(false);
+		vector<int> expected_counts(18, 0);
+		vector<int> expected_chamfer_counts(18, 0);
+		for (int x = 0; x < 20; x++) {
+			for (int y = 0; y < 20; y++) {
+				for (int z = 0; z < 21; z++) {
+					vector<int> d = { min(x, 20 - x), min(y, 20 - y), abs(z - 10) };
+					if (d[0] != 0 || d[1] != 0 || d[2] != 0) {
+						expected_counts[round_int(sqrt((double)(d[0] * d[0] + d[1] * d[1] + d[2] * d[2])))]++;
+						// The chamfer path takes diagonal steps of sqrt(3) and sqrt(2) before straight steps
+						sort(d.begin(), d.end());
+						expected_chamfer_counts[round_int(d[0] * sqrt(3.0) + (d[1] - d[0]) * sqrt(2.0) + (d[2] - d[1]))]++;
+					}
+				}
+			}
+		}
+		auto hist_inclusion = morph_inclusion.getInterfacialDistanceHistogram((char)1);
+		EXPECT_EQ(17, (int)hist_inclusion.back().first);
+		for (const auto& item : hist_inclusion) {
+			EXPECT_EQ(expected_counts[(int)item.first], item.second);
+		}
+		hist_inclusion = morph_inclusion.getInterfacialDistanceHistogram((char)2);
+		EXPECT_EQ(1, (int)hist_inclusion.size());
+		EXPECT_DOUBLE_EQ(1.0, hist_inclusion[0].first);
+		// Check that the interfacial volume fraction includes the site and its six first-nearest neighbors
+		EXPECT_DOUBLE_EQ(7.0 / (20 * 20 * 21), morph_inclusion.calculateInterfacialVolumeFraction());
+		// Check the chamfer interfacial distances around the same site
+		morph_inclusion.calculateInterfacialDistanceHistogram(true);
+		hist_inclusion = morph_inclusion.getInterfacialDistanceHistogram((char)1);
+		EXPECT_EQ(17, (int)hist_inclusion.back().first);
+		for (const auto& item : hist_inclusion) {
+			EXPECT_EQ(expected_chamfer_counts[(int)item.first], item.second);
+		}
+		// Check that the exact and chamfer distances give the same number of sites adjacent to the interface in the phase separated morphology
+		Morphology morph_chamfer = *morph_start;
+		morph_chamfer.calculateInterfacialDistanceHistogram(true);
+		EXPECT_EQ(hist1[0].second, morph_chamfer.getInterfacialDistanceHistogram((char)1)[0].second);
+		EXPECT_EQ(hist2[0].second, morph_chamfer.getInterfacialDistanceHistogram((char)2)[0].second);
 		// Get initial domain sizes
 		double domain_size1_i = morph.getDomainSize((char)1);
 		double domain_size2_i = morph.getDomainSize((char)2);
 		// Apply smoothing
-		morph.executeSmoothing(0.52, 1);
+		morph.executeSmoothing(0.52, 1, false);
 		// Save smoothed morphology
 		Morphology morph_smoothed = morph;
 		// Calculate the interfacial volume fraction and interfacial area to volume ratio of the smoothed morphology
@@ -1483,6 +1945,113 @@ namespace MorphologyTests {
 		// Check that the domain size has not greatly decreased
 		EXPECT_NEAR(domain_size1_i, morph.getDomainSize((char)1), 0.5);
 		EXPECT_NEAR(domain_size2_i, morph.getDomainSize((char)2), 0.5);
+		// Check interfacial mixing of a bilayer morphology, where half of the sites in the planes on each side of the interface should be swapped
+		params.Length = 20;
+		params.Width = 20;
+		params.Height = 20;
+		params.Enable_periodic_z = false;
+		Morphology morph_bilayer(params, 0);
+		morph_bilayer.createBilayerMorphology();
+		morph_bilayer.executeMixing(2.0, 0.5);
+		morph_bilayer.calculateDepthDependentData();
+		auto composition1 = morph_bilayer.getDepthCompositionData((char)1);
+		EXPECT_DOUBLE_EQ(1.0, composition1[8]);
+		EXPECT_DOUBLE_EQ(0.5, composition1[9]);
+		EXPECT_DOUBLE_EQ(0.5, composition1[10]);
+		EXPECT_DOUBLE_EQ(0.0, composition1[11]);
+	}
+
+	TEST_F(MorphologyTest, ChordLengthTests) {
+		// Check the chord lengths of a bilayer morphology
+		Morphology morph_bilayer(params, 0);
+		morph_bilayer.createBilayerMorphology();
+		morph_bilayer.calculateChordLengthDistributions();
+		EXPECT_DOUBLE_EQ(50.0, morph_bilayer.getMeanChordLength((char)1, 1));
+		EXPECT_DOUBLE_EQ(50.0, morph_bilayer.getMeanChordLength((char)1, 2));
+		EXPECT_DOUBLE_EQ(25.0, morph_bilayer.getMeanChordLength((char)1, 3));
+		EXPECT_DOUBLE_EQ(50.0, morph_bilayer.getMeanChordLength((char)2, 1));
+		EXPECT_DOUBLE_EQ(50.0, morph_bilayer.getMeanChordLength((char)2, 2));
+		EXPECT_DOUBLE_EQ(25.0, morph_bilayer.getMeanChordLength((char)2, 3));
+		auto hist_bilayer = morph_bilayer.getChordLengthHistogram((char)1, 3);
+		EXPECT_EQ(50 * 50, hist_bilayer[24].second);
+		// Check the chord length histograms of the phase separated morphology
+		Morphology morph = *morph_start;
+		morph.calculateChordLengthDistributions();
+		for (int direction = 1; direction <= 3; direction++) {
+			auto hist1 = morph.getChordLengthHistogram((char)1, direction);
+			auto hist2 = morph.getChordLengthHistogram((char)2, direction);
+			auto cum_hist1 = calculateCumulativeHist(calculateProbabilityHist(hist1));
+			auto cum_hist2 = calculateCumulativeHist(calculateProbabilityHist(hist2));
+			// Check that the probability histograms add up to 1
+			EXPECT_NEAR(1.0, cum_hist1.back().second, 1e-12);
+			EXPECT_NEAR(1.0, cum_hist2.back().second, 1e-12);
+			// Check that the mean chord lengths are consistent with the histograms
+			double sum = 0;
+			int count = 0;
+			for (const auto& item : hist1) {
+				sum += item.first*item.second;
+				count += item.second;
+			}
+			EXPECT_NEAR(sum / count, morph.getMeanChordLength((char)1, direction), 1e-9);
+			EXPECT_GT(morph.getMeanChordLength((char)2, direction), 1.0);
+		}
+		// Check invalid direction
+		EXPECT_THROW(morph.getChordLengthHistogram((char)1, 0), invalid_argument);
+		EXPECT_THROW(morph.getMeanChordLength((char)1, 4), invalid_argument);
+	}
+
+	TEST_F(MorphologyTest, DomainConnectivityTests) {
+		// Check the domains of a bilayer morphology
+		Morphology morph_bilayer(params, 0);
+		morph_bilayer.createBilayerMorphology();
+		EXPECT_TRUE(morph_bilayer.calculateDomainConnectivity(6));
+		EXPECT_EQ(vector<long int>(1, 50 * 50 * 25), morph_bilayer.getDomainVolumes((char)1));
+		EXPECT_EQ(vector<long int>(1, 50 * 50 * 25), morph_bilayer.getDomainVolumes((char)2));
+		EXPECT_DOUBLE_EQ(1.0, morph_bilayer.getConnectedVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(1.0, morph_bilayer.getConnectedVolumeFraction((char)2));
+		EXPECT_DOUBLE_EQ(0.0, morph_bilayer.getPercolatingVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(0.0, morph_bilayer.getPercolatingVolumeFraction((char)2));
+		auto hist_bilayer = morph_bilayer.getDomainVolumeHistogram((char)1);
+		EXPECT_EQ(17, (int)hist_bilayer.size());
+		EXPECT_EQ(1, hist_bilayer[15].second);
+		// Check that the tortuosity calculation of the non-percolating bilayer finds no paths and no islands
+		EXPECT_TRUE(morph_bilayer.calculateTortuosities(false, false));
+		EXPECT_TRUE(morph_bilayer.getTortuosityData((char)1).empty());
+		EXPECT_TRUE(morph_bilayer.getTortuosityData((char)2).empty());
+		EXPECT_DOUBLE_EQ(0.0, morph_bilayer.getIslandVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(0.0, morph_bilayer.getIslandVolumeFraction((char)2));
+		// Check the domains of a checkerboard morphology, where sites of the same type are only second-nearest neighbors
+		Morphology morph_checkerboard(params, 0);
+		morph_checkerboard.createCheckerboardMorphology();
+		EXPECT_TRUE(morph_checkerboard.calculateDomainConnectivity(6));
+		EXPECT_EQ(vector<long int>(50 * 50 * 25, 1), morph_checkerboard.getDomainVolumes((char)1));
+		EXPECT_DOUBLE_EQ(1.0 / 50.0, morph_checkerboard.getConnectedVolumeFraction((char)1));
+		EXPECT_DOUBLE_EQ(0.0, morph_checkerboard.getPercolatingVolumeFraction((char)2));
+		EXPECT_EQ(50 * 50 * 25, morph_checkerboard.getDomainVolumeHistogram((char)2)[0].second);
+		EXPECT_TRUE(morph_checkerboard.calculateDomainConnectivity(18));
+		EXPECT_EQ(vector<long int>(1, 50 * 50 * 25), morph_checkerboard.getDomainVolumes((char)1));
+		EXPECT_DOUBLE_EQ(1.0, morph_checkerboard.getPercolatingVolumeFraction((char)1));
+		EXPECT_TRUE(morph_checkerboard.calculateDomainConnectivity(26));
+		EXPECT_EQ(vector<long int>(1, 50 * 50 * 25), morph_checkerboard.getDomainVolumes((char)2));
+		EXPECT_DOUBLE_EQ(1.0, morph_checkerboard.getConnectedVolumeFraction((char)2));
+		EXPECT_DOUBLE_EQ(1.0, morph_checkerboard.getPercolatingVolumeFraction((char)2));
+		// Check invalid inputs
+		EXPECT_FALSE(morph_checkerboard.calculateDomainConnectivity(8));
+		EXPECT_THROW(morph_checkerboard.getConnectedVolumeFraction((char)3), invalid_argument);
+		// Check that the domain connectivity of the phase separated morphology agrees with the island volume determined by the pathfinding
+		Morphology morph = *morph_start;
+		EXPECT_TRUE(morph.calculateDomainConnectivity(26));
+		EXPECT_TRUE(morph.calculateTortuosities(false, true));
+		auto volumes1 = morph.getDomainVolumes((char)1);
+		auto volumes2 = morph.getDomainVolumes((char)2);
+		double volume1 = accumulate(volumes1.begin(), volumes1.end(), 0.0);
+		double volume2 = accumulate(volumes2.begin(), volumes2.end(), 0.0);
+		EXPECT_DOUBLE_EQ(50.0 * 50.0 * 50.0, volume1 + volume2);
+		EXPECT_TRUE(is_sorted(volumes1.rbegin(), volumes1.rend()));
+		EXPECT_NEAR(morph.getIslandVolumeFraction((char)1) * 50 * 50 * 50, volume1 * (1 - morph.getConnectedVolumeFraction((char)1)), 1e-6);
+		EXPECT_NEAR(morph.getIslandVolumeFraction((char)2) * 50 * 50 * 50, volume2 * (1 - morph.getConnectedVolumeFraction((char)2)), 1e-6);
+		EXPECT_GT(morph.getPercolatingVolumeFraction((char)1), 0.9);
+		EXPECT_GT(morph.getPercolatingVolumeFraction((char)2), 0.9);
 	}
 
 	TEST_F(MorphologyTest, ExportImportTests) {
@@ -1590,6 +2159,153 @@ namespace MorphologyTests {
 		ifstream infile8("./test/morphology_no_header.txt");
 		EXPECT_FALSE(morph.importMorphologyFile(infile8));
 		infile8.close();
+		// Import a compressed morphology file with CRLF line endings and without a line ending at the end of the file
+		morph = *morph_start;
+		ofstream outfile5("./test/morphology_file3.txt");
+		morph.outputMorphologyFile(outfile5, true);
+		outfile5.close();
+		ifstream infile9("./test/morphology_file3.txt");
+		string file_str((istreambuf_iterator<char>(infile9)), istreambuf_iterator<char>());
+		infile9.close();
+		file_str.pop_back();
+		string file_str_crlf;
+		for (auto c : file_str) {
+			file_str_crlf += (c == '\n') ? string("\r\n") : string(1, c);
+		}
+		ofstream outfile6("./test/morphology_file3.txt", ofstream::out | ofstream::binary);
+		outfile6 << file_str_crlf;
+		outfile6.close();
+		Morphology morph_crlf;
+		ifstream infile10("./test/morphology_file3.txt");
+		EXPECT_TRUE(morph_crlf.importMorphologyFile(infile10));
+		infile10.close();
+		EXPECT_DOUBLE_EQ(morph.getMixFraction((char)1), morph_crlf.getMixFraction((char)1));
+		EXPECT_DOUBLE_EQ(morph.calculateInterfacialAreaVolumeRatio(), morph_crlf.calculateInterfacialAreaVolumeRatio());
+		// Try importing uncompressed morphology files with a site that is assigned twice and with an incomplete site data line
+		ofstream outfile7("./test/morphology_file3.txt");
+		morph.outputMorphologyFile(outfile7, false);
+		outfile7 << "0,0,0,1" << endl;
+		outfile7.close();
+		ifstream infile11("./test/morphology_file3.txt");
+		EXPECT_FALSE(morph_crlf.importMorphologyFile(infile11));
+		infile11.close();
+		outfile7.open("./test/morphology_file3.txt");
+		morph.outputMorphologyFile(outfile7, false);
+		outfile7 << "0,0" << endl;
+		outfile7.close();
+		infile11.open("./test/morphology_file3.txt");
+		EXPECT_FALSE(morph_crlf.importMorphologyFile(infile11));
+		infile11.close();
+		// Export and import the morphology using a binary data buffer
+		morph = *morph_start;
+		vector<char> buffer;
+		morph.outputMorphologyBuffer(buffer);
+		Morphology morph_buffer;
+		EXPECT_TRUE(morph_buffer.importMorphologyBuffer(buffer));
+		EXPECT_EQ(50, morph_buffer.getLength());
+		EXPECT_EQ(50, morph_buffer.getWidth());
+		EXPECT_EQ(50, morph_buffer.getHeight());
+		EXPECT_DOUBLE_EQ(morph.getMixFraction((char)1), morph_buffer.getMixFraction((char)1));
+		EXPECT_DOUBLE_EQ(morph.calculateInterfacialAreaVolumeRatio(), morph_buffer.calculateInterfacialAreaVolumeRatio());
+		// Try importing buffers with missing data or invalid site types
+		vector<char> buffer_bad(buffer.begin(), buffer.end() - 1);
+		EXPECT_FALSE(morph_buffer.importMorphologyBuffer(buffer_bad));
+		buffer_bad = buffer;
+		buffer_bad.back() = (char)3;
+		EXPECT_FALSE(morph_buffer.importMorphologyBuffer(buffer_bad));
+		buffer_bad.resize(10);
+		EXPECT_FALSE(morph_buffer.importMorphologyBuffer(buffer_bad));
+		// Export and import binary morphology files with 1, 2, and 8 bits per site
+		vector<vector<double>> binary_mix_fractions = { { 0.5, 0.5 },{ 0.2, 0.3, 0.5 },{ 0.1, 0.2, 0.2, 0.2, 0.3 } };
+		vector<int> binary_bits = { 1, 2, 8 };
+		for (int i = 0; i < (int)binary_mix_fractions.size(); i++) {
+			morph = *morph_start;
+			if (i > 0) {
+				morph.createRandomMorphology(binary_mix_fractions[i]);
+			}
+			ofstream outfile_bin("./test/morphology_binary.bin", ofstream::out | ofstream::binary);
+			morph.outputMorphologyBinaryFile(outfile_bin);
+			outfile_bin.close();
+			// Check that the site data is packed with the expected number of bits per site
+			size_t num_types = binary_mix_fractions[i].size();
+			ifstream infile_bin("./test/morphology_binary.bin", ifstream::in | ifstream::binary | ifstream::ate);
+			EXPECT_EQ(8 + 9 * sizeof(int) + num_types + 2 * num_types * sizeof(double) + (125000 * binary_bits[i] + 7) / 8, (size_t)infile_bin.tellg());
+			infile_bin.close();
+			// Check that the imported morphology is identical to the exported morphology
+			Morphology morph_bin;
+			EXPECT_TRUE(morph_bin.importMorphologyBinaryFile("./test/morphology_binary.bin"));
+			vector<char> buffer_bin;
+			morph.outputMorphologyBuffer(buffer);
+			morph_bin.outputMorphologyBuffer(buffer_bin);
+			EXPECT_TRUE(buffer == buffer_bin);
+			EXPECT_DOUBLE_EQ(morph.getMixFraction((char)num_types), morph_bin.getMixFraction((char)num_types));
+		}
+		// Export and import a morphology created from a lattice whose first site is type 2, so that type 2 is the first site type of the morphology
+		Lattice::Lattice_Params params_lattice;
+		params_lattice.Length = 50;
+		params_lattice.Width = 50;
+		params_lattice.Height = 50;
+		params_lattice.Enable_periodic_x = true;
+		params_lattice.Enable_periodic_y = true;
+		params_lattice.Enable_periodic_z = true;
+		params_lattice.Unit_size = 1.0;
+		Lattice lattice_bilayer;
+		lattice_bilayer.init(params_lattice);
+		vector<char> site_types_bilayer(125000, (char)1);
+		for (long int n = 0; n < 125000; n++) {
+			if (n % 50 < 10) {
+				site_types_bilayer[n] = (char)2;
+			}
+		}
+		lattice_bilayer.setSiteTypes(site_types_bilayer);
+		Morphology morph_bilayer(lattice_bilayer, params, 0);
+		morph_bilayer.calculateMixFractions();
+		ofstream outfile_bilayer("./test/morphology_binary.bin", ofstream::out | ofstream::binary);
+		morph_bilayer.outputMorphologyBinaryFile(outfile_bilayer);
+		outfile_bilayer.close();
+		Morphology morph_bilayer_bin;
+		EXPECT_TRUE(morph_bilayer_bin.importMorphologyBinaryFile("./test/morphology_binary.bin"));
+		EXPECT_DOUBLE_EQ(0.8, morph_bilayer_bin.getMixFraction((char)1));
+		EXPECT_DOUBLE_EQ(0.2, morph_bilayer_bin.getMixFraction((char)2));
+		vector<char> buffer_bilayer;
+		vector<char> buffer_bilayer_bin;
+		morph_bilayer.outputMorphologyBuffer(buffer_bilayer);
+		morph_bilayer_bin.outputMorphologyBuffer(buffer_bilayer_bin);
+		EXPECT_TRUE(buffer_bilayer == buffer_bilayer_bin);
+		// The morphology buffer should also keep type 2 as the first site type
+		Morphology morph_bilayer_buffer;
+		EXPECT_TRUE(morph_bilayer_buffer.importMorphologyBuffer(buffer_bilayer));
+		EXPECT_DOUBLE_EQ(0.8, morph_bilayer_buffer.getMixFraction((char)1));
+		morph_bilayer_buffer.outputMorphologyBuffer(buffer_bilayer_bin);
+		EXPECT_TRUE(buffer_bilayer == buffer_bilayer_bin);
+		// Importing the file into a morphology that already has type 1 as its first site type should also keep the site types
+		morph = *morph_start;
+		EXPECT_TRUE(morph.importMorphologyBinaryFile("./test/morphology_binary.bin"));
+		EXPECT_DOUBLE_EQ(0.8, morph.getMixFraction((char)1));
+		EXPECT_DOUBLE_EQ(0.2, morph.getMixFraction((char)2));
+		// Try importing a missing binary file, a morphology text file, and binary files with missing data or an unsupported format version
+		EXPECT_FALSE(morph_buffer.importMorphologyBinaryFile("./test/morphology_missing.bin"));
+		EXPECT_FALSE(morph_buffer.importMorphologyBinaryFile("./test/morphology_file2.txt"));
+		vector<char> binary_data;
+		ifstream infile_bin("./test/morphology_binary.bin", ifstream::in | ifstream::binary);
+		binary_data.assign(istreambuf_iterator<char>(infile_bin), istreambuf_iterator<char>());
+		infile_bin.close();
+		ofstream outfile_bin("./test/morphology_binary.bin", ofstream::out | ofstream::binary);
+		outfile_bin.write(binary_data.data(), binary_data.size() - 1);
+		outfile_bin.close();
+		EXPECT_FALSE(morph_buffer.importMorphologyBinaryFile("./test/morphology_binary.bin"));
+		// The site type values are stored after the signature and header, and each one must be unique
+		vector<char> binary_data_bad = binary_data;
+		binary_data_bad[8 + 9 * sizeof(int) + 1] = binary_data_bad[8 + 9 * sizeof(int)];
+		outfile_bin.open("./test/morphology_binary.bin", ofstream::out | ofstream::binary);
+		outfile_bin.write(binary_data_bad.data(), binary_data_bad.size());
+		outfile_bin.close();
+		EXPECT_FALSE(morph_buffer.importMorphologyBinaryFile("./test/morphology_binary.bin"));
+		binary_data[8] = (char)99;
+		outfile_bin.open("./test/morphology_binary.bin", ofstream::out | ofstream::binary);
+		outfile_bin.write(binary_data.data(), binary_data.size());
+		outfile_bin.close();
+		EXPECT_FALSE(morph_buffer.importMorphologyBinaryFile("./test/morphology_binary.bin"));
 	}
 
 	TEST_F(MorphologyTest, OtherOutputTests) {
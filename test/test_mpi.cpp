@@ -165,6 +165,53 @@ namespace MPI_Tests {
 			}
 		}
 	}
+
+	TEST_F(MPI_Test, SendReceiveBufferTests) {
+		// Send a unique data buffer from proc 0 to each of the other procs
+		if (procid == 0) {
+			for (int i = 1; i < nproc; i++) {
+				vector<char> buffer(1000 * i, (char)i);
+				MPI_sendBuffer(buffer, i);
+			}
+		}
+		else {
+			auto buffer = MPI_receiveBuffer(0);
+			EXPECT_EQ(1000 * procid, (int)buffer.size());
+			EXPECT_EQ(1000 * procid, (int)count(buffer.begin(), buffer.end(), (char)procid));
+		}
+		// Send the buffers in chunks that do not divide the buffer sizes evenly
+		if (procid == 0) {
+			for (int i = 1; i < nproc; i++) {
+				vector<char> buffer(1000 * i);
+				for (int j = 0; j < (int)buffer.size(); j++) {
+					buffer[j] = (char)(j % 100);
+				}
+				MPI_sendBuffer(buffer, i, 300);
+			}
+		}
+		else {
+			auto buffer = MPI_receiveBuffer(0);
+			EXPECT_EQ(1000 * procid, (int)buffer.size());
+			bool is_data_correct = true;
+			for (int j = 0; j < (int)buffer.size(); j++) {
+				if (buffer[j] != (char)(j % 100)) {
+					is_data_correct = false;
+				}
+			}
+			EXPECT_TRUE(is_data_correct);
+		}
+		// Check that the maximum chunk size must be positive
+		if (procid == 0) {
+			EXPECT_THROW(MPI_sendBuffer(vector<char>(10), 1, 0), invalid_argument);
+		}
+		// Check sending and receiving an empty buffer
+		if (procid == 0) {
+			MPI_sendBuffer(vector<char>(), 1);
+		}
+		else if (procid == 1) {
+			EXPECT_TRUE(MPI_receiveBuffer(0).empty());
+		}
+	}
 }
 
 int main(int argc, char **argv) {